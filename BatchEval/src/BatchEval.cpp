@@ -0,0 +1,319 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "EPD.h"
+#include "MappedFile.h"
+#include "PackedPosition.h"
+
+#include "ChessPlayers/Bots/NeuralNetwork.h"
+
+// Scores positions with a network model, for comparing models and relabelling datasets.
+// The input is FEN / EPD lines (or a CSV with the FEN in the first column) or DataConverter's packed records.
+// Every thread has its own NeuralNetwork on the shared session and takes whole batches: it parses and encodes
+// them and runs them as one inference call, finished batches are written in input order.
+// Output is "fen,score" lines, or packed records with the new score when the output ends in .bin
+
+struct EvalSettings
+{
+	std::string inputPath;
+	std::string outputPath;
+	std::string modelPath = "Ressources/NeuralNetworks/model6b48.onnx";
+	size_t batchSize = 1024;
+	uint32_t intraOpThreads = 1;
+	uint32_t threadCount = 0; // cores / intra-op threads when not given
+};
+
+struct SharedState
+{
+	ChessCore::MappedFile input;
+	bool packedInput = false;
+	bool packedOutput = false;
+
+	std::mutex inputMutex;
+	size_t inputPosition = 0;
+	uint64_t nextBatchIndex = 0;
+
+	// batches that finished before an earlier one, written once the gap is filled
+	std::mutex outputMutex;
+	std::ofstream output;
+	uint64_t nextWriteIndex = 0;
+	std::map<uint64_t, std::string> finishedBatches;
+
+	std::atomic<uint64_t> positions = 0;
+	std::atomic<uint64_t> skipped = 0;
+	std::atomic<uint64_t> batches = 0;
+	std::atomic<uint64_t> encodeNanoseconds = 0;
+	std::atomic<uint64_t> inferenceNanoseconds = 0;
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+static constexpr size_t c_MinBatchSize = 1;
+static constexpr size_t c_MaxBatchSize = 4096;
+static constexpr uint64_t c_ProgressInterval = 100'000;
+
+static bool EndsWith(std::string_view text, std::string_view suffix)
+{
+	return text.size() >= suffix.size() && text.substr(text.size() - suffix.size()) == suffix;
+}
+
+// Takes the next batch of input lines or records, false once the input is exhausted
+static bool NextBatch(SharedState& shared, size_t batchSize, std::vector<std::string_view>& items, uint64_t& batchIndex)
+{
+	items.clear();
+
+	std::lock_guard<std::mutex> lock(shared.inputMutex);
+
+	const std::string_view data = shared.input.View();
+	if (shared.packedInput)
+	{
+		constexpr size_t recordSize = sizeof(ChessCore::PackedPosition);
+		while (items.size() < batchSize && shared.inputPosition + recordSize <= data.size())
+		{
+			items.push_back(data.substr(shared.inputPosition, recordSize));
+			shared.inputPosition += recordSize;
+		}
+	}
+	else
+	{
+		while (items.size() < batchSize && shared.inputPosition < data.size())
+		{
+			size_t lineEnd = data.find('\n', shared.inputPosition);
+			if (lineEnd == std::string_view::npos)
+				lineEnd = data.size();
+
+			std::string_view line = data.substr(shared.inputPosition, lineEnd - shared.inputPosition);
+			shared.inputPosition = lineEnd + 1;
+
+			if (!line.empty() && line != "\r")
+				items.push_back(line);
+		}
+	}
+
+	if (items.empty())
+		return false;
+
+	batchIndex = shared.nextBatchIndex++;
+	return true;
+}
+
+static void WriteBatch(SharedState& shared, uint64_t batchIndex, std::string&& data, uint64_t positionCount)
+{
+	std::lock_guard<std::mutex> lock(shared.outputMutex);
+
+	shared.finishedBatches.emplace(batchIndex, std::move(data));
+	for (auto it = shared.finishedBatches.begin(); it != shared.finishedBatches.end() && it->first == shared.nextWriteIndex;)
+	{
+		shared.output << it->second;
+		shared.nextWriteIndex++;
+		it = shared.finishedBatches.erase(it);
+	}
+
+	const uint64_t before = shared.positions.fetch_add(positionCount, std::memory_order_relaxed);
+	if ((before + positionCount) / c_ProgressInterval != before / c_ProgressInterval)
+	{
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+		std::cout << "Positions: " << before + positionCount << ", positions per second: "
+			<< (uint64_t)((before + positionCount) / std::max(seconds, 1e-9)) << std::endl;
+	}
+}
+
+static void RunWorker(const EvalSettings& settings, SharedState& shared)
+{
+	InferenceConfig config;
+	config.IntraOpThreads = settings.intraOpThreads;
+	config.InterOpThreads = 1;
+	config.MaxBatchSize = (uint16_t)settings.batchSize;
+
+	NeuralNetwork network(settings.modelPath, config);
+	if (!network.IsLoaded())
+		return;
+
+	std::vector<std::string_view> items;
+	std::vector<ChessCore::ChessBoard> boards;
+	std::vector<ChessCore::PackedPosition> records;
+	std::vector<float> scores(settings.batchSize);
+	std::string fen;
+
+	uint64_t batchIndex = 0;
+	while (NextBatch(shared, settings.batchSize, items, batchIndex))
+	{
+		const auto encodeStart = std::chrono::steady_clock::now();
+
+		boards.clear();
+		records.clear();
+		uint64_t skipped = 0;
+
+		for (std::string_view item : items)
+		{
+			ChessCore::PackedPosition record;
+			if (shared.packedInput)
+			{
+				std::memcpy(&record, item.data(), sizeof(record));
+				boards.push_back(record.ToBoard());
+			}
+			else
+			{
+				if (!ChessCore::EPDToFEN(item, fen))
+				{
+					skipped++;
+					continue;
+				}
+				boards.emplace_back(fen);
+			}
+
+			if (boards.back().GetError())
+			{
+				boards.pop_back();
+				skipped++;
+				continue;
+			}
+
+			records.push_back(record);
+		}
+
+		const auto inferenceStart = std::chrono::steady_clock::now();
+
+		network.EvaluateBatch(boards.data(), boards.size(), scores.data());
+
+		const auto inferenceEnd = std::chrono::steady_clock::now();
+
+		std::string output;
+		for (size_t i = 0; i < boards.size(); i++)
+		{
+			const int score = (int)std::lround(scores[i] * 100.0f);
+
+			if (shared.packedOutput)
+			{
+				ChessCore::PackedPosition& record = records[i];
+				if (!shared.packedInput)
+					ChessCore::PackedPosition::Encode(boards[i], score, ChessCore::TrainingResult::UNKNOWN_RESULT, record);
+				record.score = (int16_t)std::clamp(score, INT16_MIN, INT16_MAX);
+				output.append(reinterpret_cast<const char*>(&record), sizeof(record));
+			}
+			else
+			{
+				output += boards[i].GetFENString();
+				output += ',';
+				output += std::to_string(score);
+				output += '\n';
+			}
+		}
+
+		shared.skipped.fetch_add(skipped, std::memory_order_relaxed);
+		shared.batches.fetch_add(1, std::memory_order_relaxed);
+		shared.encodeNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(inferenceStart - encodeStart).count(), std::memory_order_relaxed);
+		shared.inferenceNanoseconds.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(inferenceEnd - inferenceStart).count(), std::memory_order_relaxed);
+
+		WriteBatch(shared, batchIndex, std::move(output), boards.size());
+	}
+}
+
+static bool ParseArguments(int argc, char** argv, EvalSettings& settings)
+{
+	std::vector<std::string_view> positional;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--model" && hasValue)
+			settings.modelPath = argv[++i];
+		else if (argument == "--batch" && hasValue)
+			settings.batchSize = std::clamp<size_t>(std::stoull(argv[++i]), c_MinBatchSize, c_MaxBatchSize);
+		else if (argument == "--threads" && hasValue)
+			settings.threadCount = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument == "--intra-op" && hasValue)
+			settings.intraOpThreads = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument.substr(0, 2) == "--")
+			return false;
+		else
+			positional.push_back(argument);
+	}
+
+	if (positional.size() != 2)
+		return false;
+
+	settings.inputPath = positional[0];
+	settings.outputPath = positional[1];
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	EvalSettings settings;
+	if (!ParseArguments(argc, argv, settings))
+	{
+		std::cout << "Usage: BatchEval <positions.(fen|epd|csv|bin)> <scores.(csv|bin)> [--model model.onnx] [--batch n] [--threads n] [--intra-op n]" << std::endl;
+		return 1;
+	}
+
+	// One inference thread per worker by default, the cores are used by running batches side by side
+	if (settings.threadCount == 0)
+		settings.threadCount = std::max<uint32_t>(std::thread::hardware_concurrency() / settings.intraOpThreads, 1);
+
+	SharedState shared;
+	shared.packedInput = EndsWith(settings.inputPath, ".bin");
+	shared.packedOutput = EndsWith(settings.outputPath, ".bin");
+
+	if (!shared.input.Open(settings.inputPath))
+	{
+		std::cout << "Could not open " << settings.inputPath << std::endl;
+		return 1;
+	}
+
+	if (shared.packedInput && shared.input.Size() % sizeof(ChessCore::PackedPosition) != 0)
+	{
+		std::cout << settings.inputPath << " is not a multiple of " << sizeof(ChessCore::PackedPosition) << " bytes" << std::endl;
+		return 1;
+	}
+
+	// Loaded up front so a missing model is reported before any thread starts, and held so the workers share it
+	InferenceConfig config;
+	config.IntraOpThreads = settings.intraOpThreads;
+	config.InterOpThreads = 1;
+	const std::shared_ptr<SharedModel> model = ModelRegistry::Acquire(settings.modelPath, config);
+	if (!model)
+		return 1;
+
+	shared.output.open(settings.outputPath, std::ios::binary | std::ios::trunc);
+	if (!shared.output.is_open())
+	{
+		std::cout << "Could not open " << settings.outputPath << std::endl;
+		return 1;
+	}
+
+	shared.startTime = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < settings.threadCount; i++)
+		workers.emplace_back(RunWorker, std::cref(settings), std::ref(shared));
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+	const uint64_t positions = std::max<uint64_t>(shared.positions, 1);
+
+	std::cout << "Scored " << shared.positions << " positions (" << shared.skipped << " skipped) in " << shared.batches << " batches"
+		<< " with " << settings.threadCount << " threads, " << seconds << "s\n"
+		<< "Positions per second: " << (uint64_t)(shared.positions / std::max(seconds, 1e-9)) << "\n"
+		<< "Encoding: " << shared.encodeNanoseconds / positions << "ns per position, inference: "
+		<< shared.inferenceNanoseconds / positions << "ns per position (summed over threads)" << std::endl;
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "OpeningBook.h"
+#include "PGN.h"
+
+#include "BookStatistics.h"
+
+// Compiles PGN game collections into the binary opening book.
+// The PGN is memory mapped and split into one chunk per thread at game boundaries, every thread replays
+// its games up to the depth cap and sends (position, move, result) updates to the sharded statistics
+
+struct BuilderSettings
+{
+	std::string inputPath;
+	std::string outputPath;
+	uint32_t minGames = 5;
+	uint32_t maxPly = 30;
+	size_t maxEntries = 50'000'000;
+	uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+};
+
+struct WorkerCounters
+{
+	std::atomic<uint64_t> games = 0;
+	std::atomic<uint64_t> skippedGames = 0;
+	std::atomic<uint64_t> positions = 0;
+};
+
+static constexpr size_t c_FlushInterval = 1 << 16; // updates buffered per thread before they are merged
+static constexpr uint32_t c_MaxPlyLimit = 200;	   // the board's undo stack holds 256 moves
+
+static bool StartsWith(std::string_view text, std::string_view prefix)
+{
+	return text.substr(0, prefix.size()) == prefix;
+}
+
+// Replays one game and queues an update for every book move, returns false if the game is unusable
+static bool ProcessGame(const ChessCore::PGNGame& game, const BuilderSettings& settings,
+	BookStatistics& statistics, std::vector<std::vector<BookUpdate>>& pending, size_t& pendingCount, WorkerCounters& counters)
+{
+	// Results from white's point of view
+	const std::string_view result = game.GetTag("Result");
+
+	GameResult whiteResult;
+	if (result == "1-0")
+		whiteResult = GameResult::WIN;
+	else if (result == "0-1")
+		whiteResult = GameResult::LOSS;
+	else if (result == "1/2-1/2")
+		whiteResult = GameResult::DRAW;
+	else
+		return false;
+
+	const GameResult blackResult =
+		whiteResult == GameResult::WIN ? GameResult::LOSS :
+		whiteResult == GameResult::LOSS ? GameResult::WIN :
+		GameResult::DRAW;
+
+	const std::string_view fen = game.GetTag("FEN");
+	ChessCore::ChessBoard board = fen.empty() ? ChessCore::ChessBoard() : ChessCore::ChessBoard(std::string(fen));
+
+	uint32_t ply = 0;
+	ChessCore::PGNMoveTokenizer moves = game.GetMoves();
+	std::string_view san;
+	while (ply < settings.maxPly && moves.Next(san))
+	{
+		ChessCore::Move move = board.ParseSAN(san);
+		if (move == 0)
+			break; // keep what was replayed up to the broken move
+
+		const bool whiteToMove = board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove);
+		const BookKey bookKey{ board.GetZobristKey(), ChessCore::OpeningBook::EncodeMove(move) };
+
+		const size_t shardIndex = statistics.GetShardIndex(bookKey.key);
+		pending[shardIndex].push_back({ bookKey, whiteToMove ? whiteResult : blackResult });
+		pendingCount++;
+
+		board.MakeMove(move);
+		ply++;
+	}
+
+	counters.positions.fetch_add(ply, std::memory_order_relaxed);
+	return ply > 0;
+}
+
+static void Flush(BookStatistics& statistics, std::vector<std::vector<BookUpdate>>& pending, size_t& pendingCount)
+{
+	for (size_t shardIndex = 0; shardIndex < pending.size(); shardIndex++)
+	{
+		if (pending[shardIndex].empty())
+			continue;
+
+		statistics.Merge(shardIndex, pending[shardIndex]);
+		pending[shardIndex].clear();
+	}
+	pendingCount = 0;
+}
+
+static void ProcessChunk(std::string_view chunk, const BuilderSettings& settings, BookStatistics& statistics, WorkerCounters& counters)
+{
+	std::vector<std::vector<BookUpdate>> pending(statistics.GetShardCount());
+	size_t pendingCount = 0;
+
+	ChessCore::PGNReader reader(chunk);
+	ChessCore::PGNGame game;
+	while (reader.NextGame(game))
+	{
+		if (ProcessGame(game, settings, statistics, pending, pendingCount, counters))
+			counters.games.fetch_add(1, std::memory_order_relaxed);
+		else
+			counters.skippedGames.fetch_add(1, std::memory_order_relaxed);
+
+		if (pendingCount >= c_FlushInterval)
+			Flush(statistics, pending, pendingCount);
+	}
+
+	Flush(statistics, pending, pendingCount);
+}
+
+static bool ParseArguments(int argc, char** argv, BuilderSettings& settings)
+{
+	std::vector<std::string_view> positional;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--min-games" && hasValue)
+			settings.minGames = std::stoul(argv[++i]);
+		else if (argument == "--max-ply" && hasValue)
+			settings.maxPly = std::min<uint32_t>(std::stoul(argv[++i]), c_MaxPlyLimit);
+		else if (argument == "--max-entries" && hasValue)
+			settings.maxEntries = std::stoull(argv[++i]);
+		else if (argument == "--threads" && hasValue)
+			settings.threadCount = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (StartsWith(argument, "--"))
+			return false;
+		else
+			positional.push_back(argument);
+	}
+
+	if (positional.size() != 2)
+		return false;
+
+	settings.inputPath = positional[0];
+	settings.outputPath = positional[1];
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	BuilderSettings settings;
+	if (!ParseArguments(argc, argv, settings))
+	{
+		std::cout << "Usage: BookBuilder <games.pgn> <OpeningBook.bin> [--min-games n] [--max-ply n] [--max-entries n] [--threads n]" << std::endl;
+		return 1;
+	}
+
+	ChessCore::PGNReader input(settings.inputPath);
+	if (!input.IsOpen())
+	{
+		std::cout << "Could not open " << settings.inputPath << std::endl;
+		return 1;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	BookStatistics statistics(settings.maxEntries);
+	WorkerCounters counters;
+
+	std::vector<std::thread> workers;
+	for (std::string_view chunk : ChessCore::PGNReader::SplitIntoChunks(input.GetData(), settings.threadCount))
+		workers.emplace_back(ProcessChunk, chunk, std::cref(settings), std::ref(statistics), std::ref(counters));
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	std::vector<ChessCore::BookEntry> entries = statistics.BuildEntries(settings.minGames);
+	const size_t entryCount = entries.size();
+
+	if (!ChessCore::OpeningBook::Write(settings.outputPath, std::move(entries)))
+		return 1;
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+	std::cout << "Games: " << counters.games << " (" << counters.skippedGames << " skipped)"
+		<< ", positions: " << counters.positions
+		<< ", moves tracked: " << statistics.GetEntryCount() << " (" << statistics.GetPrunedEntryCount() << " pruned)"
+		<< ", book entries: " << entryCount
+		<< ", time: " << seconds << "s" << std::endl;
+
+	return 0;
+}
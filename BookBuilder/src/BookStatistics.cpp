@@ -0,0 +1,109 @@
+#include "BookStatistics.h"
+
+#include <algorithm>
+
+BookStatistics::BookStatistics(size_t maxEntries, size_t shardCount)
+	: m_Shards(std::max<size_t>(shardCount, 1)), m_MaxEntriesPerShard(std::max<size_t>(maxEntries / m_Shards.size(), 1))
+{
+}
+
+void BookStatistics::Merge(size_t shardIndex, const std::vector<BookUpdate>& updates)
+{
+	Shard& shard = m_Shards[shardIndex];
+	std::lock_guard<std::mutex> lock(shard.mutex);
+
+	for (const BookUpdate& update : updates)
+	{
+		MoveStatistics& statistics = shard.entries[update.bookKey];
+		switch (update.result)
+		{
+		case GameResult::WIN:  statistics.wins++;   break;
+		case GameResult::DRAW: statistics.draws++;  break;
+		case GameResult::LOSS: statistics.losses++; break;
+		}
+
+		if (shard.entries.size() > m_MaxEntriesPerShard)
+			Prune(shard);
+	}
+}
+
+void BookStatistics::Prune(Shard& shard)
+{
+	// Drop the rarest moves until the shard is back to three quarters of its budget, most of a
+	// large database is moves seen once deep in the opening, which never make it into the book anyway
+	const size_t target = m_MaxEntriesPerShard * 3 / 4;
+
+	for (uint32_t threshold = 1; shard.entries.size() > target; threshold++)
+	{
+		shard.prunedEntries += std::erase_if(shard.entries, [threshold](const auto& entry)
+			{
+				return entry.second.GetGameCount() <= threshold;
+			});
+	}
+}
+
+size_t BookStatistics::GetEntryCount() const
+{
+	size_t count = 0;
+	for (const Shard& shard : m_Shards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		count += shard.entries.size();
+	}
+	return count;
+}
+
+uint64_t BookStatistics::GetPrunedEntryCount() const
+{
+	uint64_t count = 0;
+	for (const Shard& shard : m_Shards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		count += shard.prunedEntries;
+	}
+	return count;
+}
+
+std::vector<ChessCore::BookEntry> BookStatistics::BuildEntries(uint32_t minGames) const
+{
+	std::vector<ChessCore::BookEntry> entries;
+	std::vector<uint64_t> weights;
+
+	// Highest weight in every position, only the moves of one position are compared when picking a move
+	std::unordered_map<uint64_t, uint64_t> maxWeights;
+
+	for (const Shard& shard : m_Shards)
+	{
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		for (const auto& [bookKey, statistics] : shard.entries)
+		{
+			if (statistics.GetGameCount() < minGames)
+				continue;
+
+			// Only losing moves get weight 0 and are never picked, leave them out
+			uint64_t weight = 2ULL * statistics.wins + statistics.draws;
+			if (weight == 0)
+				continue;
+
+			ChessCore::BookEntry entry;
+			entry.key = bookKey.key;
+			entry.move = bookKey.move;
+			entries.push_back(entry);
+			weights.push_back(weight);
+
+			uint64_t& maxWeight = maxWeights[bookKey.key];
+			maxWeight = std::max(maxWeight, weight);
+		}
+	}
+
+	// Scale each position down so its most played move still fits into the 16 bit weight,
+	// scaling by the whole book's maximum would flatten every rarely reached position to 1
+	for (size_t i = 0; i < entries.size(); i++)
+	{
+		const uint64_t maxWeight = maxWeights[entries[i].key];
+		uint64_t weight = maxWeight > UINT16_MAX ? weights[i] * UINT16_MAX / maxWeight : weights[i];
+		entries[i].weight = static_cast<uint16_t>(std::max<uint64_t>(weight, 1));
+	}
+
+	return entries;
+}
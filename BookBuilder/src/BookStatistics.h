@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "OpeningBook.h"
+
+enum class GameResult : uint8_t
+{
+	WIN,
+	DRAW,
+	LOSS,
+};
+
+// Results of one book move, seen from the side that played it
+struct MoveStatistics
+{
+	uint32_t wins = 0;
+	uint32_t draws = 0;
+	uint32_t losses = 0;
+
+	uint32_t GetGameCount() const { return wins + draws + losses; }
+};
+
+struct BookKey
+{
+	uint64_t key = 0;
+	uint16_t move = 0;
+
+	bool operator==(const BookKey& other) const { return key == other.key && move == other.move; }
+};
+
+struct BookKeyHash
+{
+	size_t operator()(const BookKey& bookKey) const { return bookKey.key ^ (bookKey.move * 0x9E3779B97F4A7C15ULL); }
+};
+
+struct BookUpdate
+{
+	BookKey bookKey;
+	GameResult result;
+};
+
+// (position, move) -> results, split into shards with a lock each so the PGN workers rarely wait on each other.
+// Every shard has a fixed entry budget, a full shard drops its rarest moves so memory stays bounded on any input size
+class BookStatistics
+{
+public:
+	BookStatistics(size_t maxEntries, size_t shardCount = 64);
+
+	size_t GetShardCount() const { return m_Shards.size(); }
+	size_t GetShardIndex(uint64_t key) const { return (key >> 32) % m_Shards.size(); }
+
+	// Adds a batch of updates that all belong to the given shard
+	void Merge(size_t shardIndex, const std::vector<BookUpdate>& updates);
+
+	size_t GetEntryCount() const;
+	uint64_t GetPrunedEntryCount() const;
+
+	// Moves played in at least minGames games, weighted 2 per win and 1 per draw like Polyglot books
+	std::vector<ChessCore::BookEntry> BuildEntries(uint32_t minGames) const;
+
+private:
+	struct Shard
+	{
+		mutable std::mutex mutex;
+		std::unordered_map<BookKey, MoveStatistics, BookKeyHash> entries;
+		uint64_t prunedEntries = 0;
+	};
+
+	void Prune(Shard& shard);
+
+private:
+	std::vector<Shard> m_Shards;
+	size_t m_MaxEntriesPerShard;
+};
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "OpeningBook.h"
+
+// Converts the text opening book ("FEN,uci" per line) into the sorted binary book the bot maps.
+// A position/move pair that appears several times gets a proportionally higher weight
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cout << "Usage: BookConverter <OpeningBook.txt> <OpeningBook.bin>" << std::endl;
+		return 1;
+	}
+
+	std::ifstream input(argv[1]);
+	if (!input.is_open())
+	{
+		std::cout << "Could not open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::map<std::pair<uint64_t, uint16_t>, uint32_t> counts;
+	size_t lineCount = 0;
+	size_t skipped = 0;
+
+	std::string line;
+	while (std::getline(input, line))
+	{
+		lineCount++;
+
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+
+		size_t position = line.find(',');
+		if (position == std::string::npos || position + 1 >= line.size())
+		{
+			skipped++;
+			continue;
+		}
+
+		ChessCore::ChessBoard board(line.substr(0, position));
+		ChessCore::Move move = board.ParseUCI(std::string_view(line).substr(position + 1));
+		if (move == 0)
+		{
+			skipped++;
+			continue;
+		}
+
+		counts[{ board.GetZobristKey(), ChessCore::OpeningBook::EncodeMove(move) }]++;
+	}
+
+	std::vector<ChessCore::BookEntry> entries;
+	entries.reserve(counts.size());
+	for (const auto& [keyMove, count] : counts)
+	{
+		ChessCore::BookEntry entry;
+		entry.key = keyMove.first;
+		entry.move = keyMove.second;
+		entry.weight = static_cast<uint16_t>(std::min<uint32_t>(count, UINT16_MAX));
+		entries.push_back(entry);
+	}
+
+	if (!ChessCore::OpeningBook::Write(argv[2], std::move(entries)))
+		return 1;
+
+	std::cout << "Read " << lineCount << " lines (" << skipped << " skipped), wrote " << counts.size() << " entries to " << argv[2] << std::endl;
+
+	return 0;
+}
@@ -11,4 +11,14 @@ include "ChessCore/Build-ChessCore.lua"
 
 include "NeraCore/Build-NeraCore.lua"
 
-include "NeraChessApp/Build-NeraChessApp.lua"
\ No newline at end of file
+include "NeraChessApp/Build-NeraChessApp.lua"
+
+group "Tools"
+   include "BookConverter/Build-BookConverter.lua"
+   include "BookBuilder/Build-BookBuilder.lua"
+   include "DataGen/Build-DataGen.lua"
+   include "DataConverter/Build-DataConverter.lua"
+   include "TrainingData/Build-TrainingData.lua"
+   include "BatchEval/Build-BatchEval.lua"
+   include "MatchRunner/Build-MatchRunner.lua"
+group ""
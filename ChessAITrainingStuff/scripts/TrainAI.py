@@ -31,6 +31,7 @@ Channels:
 """
 
 import argparse
+import ctypes
 import os
 import sys
 import time
@@ -39,10 +40,11 @@ import pickle
 from pathlib import Path
 from typing import List, Tuple
 
+import numpy as np
 import torch
 import torch.nn as nn
 import torch.nn.functional as F
-from torch.utils.data import Dataset, DataLoader
+from torch.utils.data import Dataset, DataLoader, BatchSampler, RandomSampler
 
 # ----------------------------- Dataset -----------------------------
 class FenDataset(Dataset):
@@ -87,8 +89,9 @@ class FenDataset(Dataset):
         self._open_file_if_needed()
         self._file.seek(offset)
         line = self._file.readline()
-        parts = line.rsplit(',', 1)
-        if len(parts) != 2:
+        # fen,score from CreateDataSet.py or fen,score,result from DataGen
+        parts = line.strip().split(',')
+        if len(parts) < 2:
             raise ValueError(f"Malformed line: {line!r}")
         fen_str = parts[0].strip()
         eval_str = parts[1].strip()
@@ -102,6 +105,57 @@ class FenDataset(Dataset):
         tensor = fen_to_tensor(fen_str)
         return tensor, torch.tensor([target], dtype=torch.float32)
 
+class PackedDataset(Dataset):
+    """
+    32 byte records written by DataConverter, decoded a whole batch at a time by the TrainingData library.
+    Indexed with lists of indices (use it with a BatchSampler), the tensors use NeuralNetwork::BoardToTensor's
+    layout where rank index 0 is white's first rank.
+    """
+    RECORD_SIZE = 32
+
+    def __init__(self, bin_path: str, lib_path: str, clip_pawns: float = 20.0):
+        self.bin_path = Path(bin_path)
+        self.lib_path = Path(lib_path)
+        self.clip_pawns = clip_pawns
+        size = self.bin_path.stat().st_size
+        if size % self.RECORD_SIZE != 0:
+            raise ValueError(f"{self.bin_path} is not a multiple of {self.RECORD_SIZE} bytes")
+        self.count = size // self.RECORD_SIZE
+        # opened lazily so the dataset can be pickled into the DataLoader workers
+        self._records = None
+        self._lib = None
+
+    def __len__(self):
+        return self.count
+
+    def _open_if_needed(self):
+        if self._lib is None:
+            lib = ctypes.CDLL(str(self.lib_path))
+            lib.TrainingData_GetRecordSize.restype = ctypes.c_uint32
+            lib.TrainingData_DecodeBatch.restype = None
+            lib.TrainingData_DecodeBatch.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint64,
+                                                     ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+            if lib.TrainingData_GetRecordSize() != self.RECORD_SIZE:
+                raise RuntimeError(f"{self.lib_path} was built for a different record size")
+            self._lib = lib
+        if self._records is None:
+            self._records = np.memmap(self.bin_path, dtype=np.uint8, mode='r')
+
+    def __getitem__(self, indices):
+        self._open_if_needed()
+        indices = np.ascontiguousarray(indices, dtype=np.uint64)
+        count = len(indices)
+        tensors = torch.empty((count, 19, 8, 8), dtype=torch.float32)
+        scores = torch.empty((count,), dtype=torch.float32)
+        self._lib.TrainingData_DecodeBatch(self._records.ctypes.data, indices.ctypes.data, count,
+                                           tensors.data_ptr(), scores.data_ptr(), None)
+        targets = (scores / 100.0).clamp_(-self.clip_pawns, self.clip_pawns)
+        return tensors, targets
+
+def default_training_data_lib() -> str:
+    name = 'TrainingData.dll' if sys.platform == 'win32' else 'libTrainingData.so'
+    return str(Path(__file__).resolve().parents[2] / 'bin' / 'Release' / 'TrainingData' / name)
+
 # ----------------------------- FEN -> Tensor -----------------------------
 _piece_map = {
     'P': 0,'N': 1,'B': 2,'R': 3,'Q': 4,'K': 5,
@@ -190,9 +244,16 @@ def collate_fn(batch):
 def train(args):
     device = torch.device('cuda' if torch.cuda.is_available() else 'cpu')
     print(f"Device: {device}")
-    dataset = FenDataset(args.csv, clip_pawns=20.0)
-    loader = DataLoader(dataset, batch_size=args.batch_size, shuffle=True, num_workers=args.workers,
-                        pin_memory=True if device.type=='cuda' else False, collate_fn=collate_fn)
+    if args.csv.endswith('.bin'):
+        # packed records from DataConverter, the dataset returns whole batches
+        dataset = PackedDataset(args.csv, args.lib, clip_pawns=20.0)
+        loader = DataLoader(dataset, batch_size=None, num_workers=args.workers,
+                            sampler=BatchSampler(RandomSampler(dataset), args.batch_size, drop_last=False),
+                            pin_memory=True if device.type=='cuda' else False)
+    else:
+        dataset = FenDataset(args.csv, clip_pawns=20.0)
+        loader = DataLoader(dataset, batch_size=args.batch_size, shuffle=True, num_workers=args.workers,
+                            pin_memory=True if device.type=='cuda' else False, collate_fn=collate_fn)
     model = ChessResNet(in_channels=19, filters=args.filters, blocks=args.blocks).to(device)
     optimizer = torch.optim.Adam(model.parameters(), lr=args.lr)
     scaler = torch.amp.GradScaler('cuda', enabled=(device.type=='cuda'))
@@ -266,7 +327,8 @@ def train(args):
 # ----------------------------- CLI -----------------------------
 def parse_args():
     p = argparse.ArgumentParser(description='Train chess value network from FEN CSV')
-    p.add_argument('--csv', type=str, default='chessData.csv')
+    p.add_argument('--csv', type=str, default='chessData.csv', help='FEN CSV or a .bin from DataConverter')
+    p.add_argument('--lib', type=str, default=default_training_data_lib(), help='TrainingData library for .bin files')
     p.add_argument('--batch-size', type=int, default=32)
     p.add_argument('--epochs', type=int, default=5)
     p.add_argument('--lr', type=float, default=1e-4)
@@ -5,6 +5,7 @@ project "ChessCore"
   targetdir ("../bin/%{cfg.buildcfg}/%{prj.name}")
   objdir ("../bin/Intermediates/%{cfg.builcfg}/%{prj.name}")
   staticruntime "off"
+  pic "On" -- also linked into the TrainingData shared library
 
   files
   {
@@ -187,6 +187,8 @@ namespace ChessCore
 
 		m_RepetitionTable.AddEntry(m_BoardState.pieceBitboards);
 
+		m_StaticEval = StaticEval::Calculate(m_BoardState);
+
 		m_ZobristKey = Zobrist::CalculateZobristKey(*this);
 
 	}
@@ -218,6 +220,7 @@ namespace ChessCore
 			if ((m_BoardState.pieceBitboards[piece] >> square) & 1ULL)
 			{
 				m_BoardState.pieceBitboards[piece] &= ~(1ULL << square);
+				m_StaticEval.RemovePiece(piece, square);
 				return;
 			}
 		}
@@ -227,6 +230,7 @@ namespace ChessCore
 	{
 		RemovePiece(square);
 		m_BoardState.pieceBitboards[piece] |= (1ULL << square);
+		m_StaticEval.AddPiece(piece, square);
 	}
 
 	Piece ChessBoard::GetPiece(const uint8_t square) const
@@ -283,6 +287,7 @@ namespace ChessCore
 		info.castlingRights = m_BoardState.GetCastlingRights();
 		info.enPassantFile = m_BoardState.HasFlag(BoardStateFlags::CanEnPassent) ? m_BoardState.enPassantFile : 8;
 		info.halfmoveClock = m_HalfMoveClock;
+		info.staticEval = m_StaticEval;
 
 		if (!gameMove)
 			m_UndoStack.push(info);
@@ -295,6 +300,9 @@ namespace ChessCore
 		movePieceBoard &= ~startSquareBitboard;
 		movePieceBoard |= targetSquareBitboard;
 
+		m_StaticEval.RemovePiece(movePiece, startSquare);
+		m_StaticEval.AddPiece(movePiece, targetSquare);
+
 		m_HalfMoveClock++;
 		if (movePiece == PieceType::WHITE_PAWN || movePiece == PieceType::BLACK_PAWN || (moveFlags & MoveFlags::IS_CAPTURE))
 		{
@@ -307,6 +315,11 @@ namespace ChessCore
 		{
 			m_BoardState.pieceBitboards[capturedPiece] &= ~targetSquareBitboard;
 
+			if (moveFlags & MoveFlags::IS_EN_PASSANT)
+				m_StaticEval.RemovePiece(capturedPiece, targetSquare + (whitesMove ? -8 : 8));
+			else
+				m_StaticEval.RemovePiece(capturedPiece, targetSquare);
+
 			if (capturedPiece == PieceType::WHITE_ROOK && targetSquare == 0)
 			{
 				m_BoardState.boardStateFlags &= ~BoardStateFlags::CanWhiteCastleQueen;
@@ -344,11 +357,15 @@ namespace ChessCore
 				{
 					m_BoardState.pieceBitboards[PieceType::WHITE_ROOK] &= ~s_SquareBitboard[0];
 					m_BoardState.pieceBitboards[PieceType::WHITE_ROOK] |= s_SquareBitboard[3];
+					m_StaticEval.RemovePiece(PieceType::WHITE_ROOK, 0);
+					m_StaticEval.AddPiece(PieceType::WHITE_ROOK, 3);
 				}
 				else
 				{
 					m_BoardState.pieceBitboards[PieceType::WHITE_ROOK] &= ~s_SquareBitboard[7];
 					m_BoardState.pieceBitboards[PieceType::WHITE_ROOK] |= s_SquareBitboard[5];
+					m_StaticEval.RemovePiece(PieceType::WHITE_ROOK, 7);
+					m_StaticEval.AddPiece(PieceType::WHITE_ROOK, 5);
 				}
 
 			}
@@ -361,11 +378,15 @@ namespace ChessCore
 				{
 					m_BoardState.pieceBitboards[PieceType::BLACK_ROOK] &= ~s_SquareBitboard[56];
 					m_BoardState.pieceBitboards[PieceType::BLACK_ROOK] |= s_SquareBitboard[59];
+					m_StaticEval.RemovePiece(PieceType::BLACK_ROOK, 56);
+					m_StaticEval.AddPiece(PieceType::BLACK_ROOK, 59);
 				}
 				else
 				{
 					m_BoardState.pieceBitboards[PieceType::BLACK_ROOK] &= ~s_SquareBitboard[63];
 					m_BoardState.pieceBitboards[PieceType::BLACK_ROOK] |= s_SquareBitboard[61];
+					m_StaticEval.RemovePiece(PieceType::BLACK_ROOK, 63);
+					m_StaticEval.AddPiece(PieceType::BLACK_ROOK, 61);
 				}
 
 
@@ -420,6 +441,9 @@ namespace ChessCore
 		{
 			movePieceBoard &= ~targetSquareBitboard;
 			m_BoardState.pieceBitboards[promoPiece] |= targetSquareBitboard;
+
+			m_StaticEval.RemovePiece(movePiece, targetSquare);
+			m_StaticEval.AddPiece(promoPiece, targetSquare);
 		}
 	
 		m_MovesPlayed.push_back(move);
@@ -473,6 +497,7 @@ namespace ChessCore
 			m_FullMoves--;
 
 		m_HalfMoveClock = info.halfmoveClock;
+		m_StaticEval = info.staticEval;
 
 		movePieceBoard |= startSquareBitboard;
 		movePieceBoard &= ~targetSquareBitboard;
@@ -546,28 +571,51 @@ namespace ChessCore
 		if (IsInCheck())
 			return false;
 
-		if (m_BoardState.HasFlag(BoardStateFlags::WhiteToMove))
-		{
-			m_BoardState.boardStateFlags &= ~(uint8_t)BoardStateFlags::WhiteToMove;
-		}
-		else
-		{
-			m_BoardState.boardStateFlags |= (uint8_t)BoardStateFlags::WhiteToMove;
-		}
+		m_WasBoardStateChanged = true;
+		m_GameOverFlags = 0;
+
+		UndoInfo info{};
+		info.capturedPiece = PieceType::NO_PIECE;
+		info.castlingRights = m_BoardState.GetCastlingRights();
+		info.enPassantFile = m_BoardState.enPassantFile;
+		info.halfmoveClock = m_HalfMoveClock;
+		info.staticEval = m_StaticEval;
+
+		m_UndoStack.push(info);
+
+		if (m_ZobristKeySet)
+			m_ZobristKey ^= Zobrist::sideToMove ^ Zobrist::enPassantFile[m_BoardState.enPassantFile] ^ Zobrist::enPassantFile[8];
+
+		// passing gives up the en passant capture
+		m_BoardState.boardStateFlags &= ~BoardStateFlags::CanEnPassent;
+		m_BoardState.enPassantFile = 8;
+
+		m_BoardState.boardStateFlags ^= BoardStateFlags::WhiteToMove;
+
+		m_HalfMoveClock++;
 
 		return true;
 	}
 
 	void ChessBoard::UndoNullMove()
 	{
-		if (m_BoardState.HasFlag(BoardStateFlags::WhiteToMove))
-		{
-			m_BoardState.boardStateFlags &= ~(uint8_t)BoardStateFlags::WhiteToMove;
-		}
-		else
+		m_WasBoardStateChanged = true;
+		m_GameOverFlags = 0;
+
+		UndoInfo info = m_UndoStack.pop();
+
+		m_BoardState.boardStateFlags ^= BoardStateFlags::WhiteToMove;
+
+		if (info.enPassantFile != 8)
 		{
-			m_BoardState.boardStateFlags |= (uint8_t)BoardStateFlags::WhiteToMove;
+			m_BoardState.boardStateFlags |= BoardStateFlags::CanEnPassent;
+			m_BoardState.enPassantFile = info.enPassantFile;
 		}
+
+		m_HalfMoveClock = info.halfmoveClock;
+
+		if (m_ZobristKeySet)
+			m_ZobristKey ^= Zobrist::sideToMove ^ Zobrist::enPassantFile[8] ^ Zobrist::enPassantFile[m_BoardState.enPassantFile];
 	}
 
 	MoveList<218> ChessBoard::GetLegalMoves() const
@@ -769,6 +817,222 @@ namespace ChessCore
 		return fen;
 	}
 
+	// Piece letters in SAN, indexed by piece type % 6
+	static constexpr char s_SANPieceLetters[6] = { 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+	static int GetSANPieceKind(char letter)
+	{
+		for (int kind = 1; kind < 6; kind++)
+		{
+			if (s_SANPieceLetters[kind] == letter)
+				return kind;
+		}
+		return -1;
+	}
+
+	Bitboard ChessBoard::GetSANCandidates(uint8_t pieceKind, Square target) const
+	{
+		const bool whiteToMove = m_BoardState.HasFlag(BoardStateFlags::WhiteToMove);
+		const Bitboard pieces = m_BoardState.pieceBitboards[pieceKind + (whiteToMove ? 0 : 6)];
+
+		Bitboard occupied = 0;
+		for (Bitboard pieceBitboard : m_BoardState.pieceBitboards)
+			occupied |= pieceBitboard;
+
+		switch (pieceKind)
+		{
+		case 1:
+			return pieces & MoveGenerator::s_KnightMoveMask[target];
+		case 2:
+			return pieces & MoveGenerator::GetSlidingAttacks(target, occupied, false);
+		case 3:
+			return pieces & MoveGenerator::GetSlidingAttacks(target, occupied, true);
+		case 4:
+			return pieces & (MoveGenerator::GetSlidingAttacks(target, occupied, false) | MoveGenerator::GetSlidingAttacks(target, occupied, true));
+		case 5:
+			return pieces & MoveGenerator::s_KingMoveMask[target];
+		default:
+			return pieces;
+		}
+	}
+
+	std::string ChessBoard::ToSAN(Move move) const
+	{
+		std::string san;
+		san.reserve(8);
+
+		const Square startSquare = move.GetStartSquare();
+		const Square targetSquare = move.GetTargetSquare();
+		const uint8_t moveFlags = move.GetMoveFlags();
+
+		if (moveFlags & MoveFlags::IS_CASTLES)
+		{
+			san = targetSquare.GetFile() == 6 ? "O-O" : "O-O-O";
+		}
+		else
+		{
+			const uint8_t pieceKind = move.GetMovePiece() % 6;
+			const bool isCapture = moveFlags & (MoveFlags::IS_CAPTURE | MoveFlags::IS_EN_PASSANT);
+
+			if (pieceKind == 0)
+			{
+				if (isCapture)
+					san.push_back('a' + startSquare.GetFile());
+			}
+			else
+			{
+				san.push_back(s_SANPieceLetters[pieceKind]);
+
+				// Only pieces that can legally go to the target need disambiguation, a pinned one doesn't
+				const Bitboard others = GetSANCandidates(pieceKind, targetSquare) & ~s_SquareBitboard[startSquare];
+				if (others)
+				{
+					Bitboard ambiguous = 0;
+					for (Move other : GetLegalMoves())
+					{
+						if (other.GetTargetSquare() == targetSquare && (others & s_SquareBitboard[other.GetStartSquare()]))
+							ambiguous |= s_SquareBitboard[other.GetStartSquare()];
+					}
+
+					if (ambiguous)
+					{
+						const bool sharesFile = ambiguous & (Square::FileA << startSquare.GetFile());
+						const bool sharesRank = ambiguous & (Square::Rank1 << (startSquare.GetRank() * 8));
+
+						if (!sharesFile || sharesRank)
+							san.push_back('a' + startSquare.GetFile());
+						if (sharesFile)
+							san.push_back('1' + startSquare.GetRank());
+					}
+				}
+			}
+
+			if (isCapture)
+				san.push_back('x');
+
+			san.append(targetSquare.ToString());
+
+			if (moveFlags & MoveFlags::IS_PROMOTION)
+			{
+				san.push_back('=');
+				san.push_back(s_SANPieceLetters[move.GetPromoPiece() % 6]);
+			}
+		}
+
+		ChessBoard next = *this;
+		next.MakeMove(move);
+		if (next.IsInCheck())
+			san.push_back(next.GetLegalMoves().size() == 0 ? '#' : '+');
+
+		return san;
+	}
+
+	Move ChessBoard::ParseSAN(std::string_view san) const
+	{
+		while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+			san.remove_suffix(1);
+
+		if (m_WasBoardStateChanged)
+		{
+			m_LegalMoves = m_MoveGenerator.GenerateMoves(m_BoardState);
+			m_WasBoardStateChanged = false;
+		}
+
+		if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+		{
+			const uint8_t targetFile = san.size() == 3 ? 6 : 2;
+			for (Move move : m_LegalMoves)
+			{
+				if ((move.GetMoveFlags() & MoveFlags::IS_CASTLES) && move.GetTargetSquare().GetFile() == targetFile)
+					return move;
+			}
+			return 0;
+		}
+
+		int promoKind = -1;
+		if (san.size() >= 3 && GetSANPieceKind(san.back()) > 0)
+		{
+			promoKind = GetSANPieceKind(san.back());
+			san.remove_suffix(1);
+			if (san.back() == '=')
+				san.remove_suffix(1);
+		}
+
+		uint8_t pieceKind = 0;
+		if (!san.empty() && GetSANPieceKind(san.front()) > 0)
+		{
+			pieceKind = GetSANPieceKind(san.front());
+			san.remove_prefix(1);
+		}
+
+		if (san.size() < 2)
+			return 0;
+
+		const char targetFile = san[san.size() - 2];
+		const char targetRank = san[san.size() - 1];
+		if (targetFile < 'a' || targetFile > 'h' || targetRank < '1' || targetRank > '8')
+			return 0;
+
+		const Square targetSquare(targetFile - 'a', targetRank - '1');
+		san.remove_suffix(2);
+
+		// What is left is the disambiguation and the capture mark
+		Bitboard candidates = GetSANCandidates(pieceKind, targetSquare);
+		for (char character : san)
+		{
+			if (character >= 'a' && character <= 'h')
+				candidates &= Square::FileA << (character - 'a');
+			else if (character >= '1' && character <= '8')
+				candidates &= Square::Rank1 << ((character - '1') * 8);
+			else if (character != 'x' && character != ':' && character != '-')
+				return 0;
+		}
+
+		if (!candidates)
+			return 0;
+
+		Move found = 0;
+		for (Move move : m_LegalMoves)
+		{
+			if (move.GetTargetSquare() != targetSquare || !(candidates & s_SquareBitboard[move.GetStartSquare()]))
+				continue;
+
+			const bool isPromotion = move.GetMoveFlags() & MoveFlags::IS_PROMOTION;
+			if (isPromotion != (promoKind > 0) || (isPromotion && move.GetPromoPiece() % 6 != promoKind))
+				continue;
+
+			if (found)
+				return 0;
+			found = move;
+		}
+
+		return found;
+	}
+
+	Move ChessBoard::ParseUCI(std::string_view uci) const
+	{
+		if (uci.size() < 4 || uci[0] < 'a' || uci[0] > 'h' || uci[1] < '1' || uci[1] > '8' || uci[2] < 'a' || uci[2] > 'h' || uci[3] < '1' || uci[3] > '8')
+			return 0;
+
+		const Square startSquare(uci[0] - 'a', uci[1] - '1');
+		const Square targetSquare(uci[2] - 'a', uci[3] - '1');
+		const int promoKind = uci.size() >= 5 ? GetSANPieceKind(uci[4] - 'a' + 'A') : -1;
+
+		for (Move move : GetLegalMoves())
+		{
+			if (move.GetStartSquare() != startSquare || move.GetTargetSquare() != targetSquare)
+				continue;
+
+			const bool isPromotion = move.GetMoveFlags() & MoveFlags::IS_PROMOTION;
+			if (isPromotion != (promoKind > 0) || (isPromotion && move.GetPromoPiece() % 6 != promoKind))
+				continue;
+
+			return move;
+		}
+
+		return 0;
+	}
+
 	void ChessBoard::RunPerformanceTest(ChessBoard& board, int calcDepth)
 	{
 		if (calcDepth <= 0)
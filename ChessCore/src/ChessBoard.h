@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "ChessUtil.h"
@@ -11,6 +12,7 @@
 #include "Undo.h"
 #include "MoveList.h"
 #include "BoardState.h"
+#include "StaticEval.h"
 #include "RepetitionTable.h"
 #include "MoveGenerator.h"
 
@@ -52,10 +54,12 @@ namespace ChessCore
         void MakeMove(Move move, bool gameMove = false);
 	    void UndoMove(Move move);
 
-	    bool MakeNullMove(); // TODO: implement correctly
-	    void UndoNullMove(); // TODO: implement correctly
+	    // Passes the turn, returns false (and does nothing) when in check
+	    bool MakeNullMove();
+	    void UndoNullMove();
 
 	    const BoardState& GetBoardState() const { return m_BoardState; }
+	    const StaticEval& GetStaticEval() const { return m_StaticEval; }
 
 	    uint8_t GetHalfMoveClock() const{ return m_HalfMoveClock; }
 	    uint16_t GetFullMoveClock() const { return m_FullMoves; }
@@ -67,6 +71,13 @@ namespace ChessCore
         uint64_t GetZobristKey() const;
         std::string GetFENString() const;
 
+        // Standard algebraic notation of a legal move ("Nbd7", "exd8=Q+", "O-O")
+        std::string ToSAN(Move move) const;
+        // Legal move written in SAN, 0 if there is none or it is ambiguous. Check marks and annotations are ignored, nothing is allocated
+        Move ParseSAN(std::string_view san) const;
+        // Legal move written in UCI, 0 if there is none
+        Move ParseUCI(std::string_view uci) const;
+
         uint8_t GetError() const { return m_Error; }
 
         bool operator==(const ChessBoard& other) const;
@@ -78,6 +89,10 @@ namespace ChessCore
 
         static uint64_t PerfTest(int depth, ChessBoard& board);
 
+        // Pieces of the side to move and the given kind (piece type % 6) that could reach target, from the attack tables.
+        // Pawns are returned as a whole since pushes aren't attacks, the legal moves sort them out
+        Bitboard GetSANCandidates(uint8_t pieceKind, Square target) const;
+
 	    static bool InsufficentMaterial(ChessBoard board);
 
     private:
@@ -93,6 +108,7 @@ namespace ChessCore
         mutable uint16_t m_GameOverFlags = 0;
 
         BoardState m_BoardState{};
+        StaticEval m_StaticEval{};
 
 	    RepetitionTable m_RepetitionTable{};
 	    UndoStack m_UndoStack{};
@@ -3,5 +3,84 @@
 namespace ChessCore
 {
 
+	Clock::Clock(Duration baseTime, Duration increment)
+	{
+		SetTimeControl(baseTime, increment);
+		m_RemainingTime = m_BaseTime;
+	}
 
-}
\ No newline at end of file
+	void Clock::SetTimeControl(Duration baseTime, Duration increment)
+	{
+		SetTimeControl(true, baseTime, increment);
+		SetTimeControl(false, baseTime, increment);
+	}
+
+	void Clock::SetTimeControl(bool white, Duration baseTime, Duration increment)
+	{
+		m_BaseTime[white] = baseTime;
+		m_Increment[white] = increment;
+	}
+
+	void Clock::Start(bool whiteToMove)
+	{
+		m_RemainingTime = m_BaseTime;
+		m_WhiteToMove = whiteToMove;
+		m_Running = true;
+		m_Paused = false;
+		m_TurnStart = std::chrono::steady_clock::now();
+	}
+
+	void Clock::Press()
+	{
+		if (!m_Running)
+			return;
+
+		UpdateRemainingTime();
+
+		m_RemainingTime[m_WhiteToMove] += m_Increment[m_WhiteToMove];
+		m_WhiteToMove = !m_WhiteToMove;
+	}
+
+	void Clock::Stop()
+	{
+		UpdateRemainingTime();
+		m_Running = false;
+		m_Paused = false;
+	}
+
+	void Clock::Pause()
+	{
+		UpdateRemainingTime();
+		m_Paused = true;
+	}
+
+	void Clock::Resume()
+	{
+		if (!m_Paused)
+			return;
+
+		m_Paused = false;
+		m_TurnStart = std::chrono::steady_clock::now();
+	}
+
+	Clock::Duration Clock::GetRemainingTime(bool white) const
+	{
+		Duration remaining = m_RemainingTime[white];
+
+		if (IsRunning() && white == m_WhiteToMove)
+			remaining -= std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - m_TurnStart);
+
+		return remaining;
+	}
+
+	void Clock::UpdateRemainingTime()
+	{
+		const TimePoint now = std::chrono::steady_clock::now();
+
+		if (IsRunning())
+			m_RemainingTime[m_WhiteToMove] -= std::chrono::duration_cast<Duration>(now - m_TurnStart);
+
+		m_TurnStart = now;
+	}
+
+} // namespace ChessCore
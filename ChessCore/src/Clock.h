@@ -1,46 +1,60 @@
 #pragma once
 
 #include <chrono>
+#include <array>
 
 namespace ChessCore
 {
 
+	// Chess clock with remaining time and increment per side,
+	// only the side to move has its time running
 	class Clock
 	{
 	public:
-		Clock() = default;
-		~Clock() = default;
+		using Duration = std::chrono::milliseconds;
 
+		Clock(Duration baseTime = std::chrono::minutes(5), Duration increment = std::chrono::seconds(3));
+		~Clock() = default;
 
 	public:
-		void Start()
-		{
-		}
+		void SetTimeControl(Duration baseTime, Duration increment);
+		void SetTimeControl(bool white, Duration baseTime, Duration increment);
 
-		void Press()
-		{
+		// Resets both sides to the base time and runs the clock of the side to move
+		void Start(bool whiteToMove = true);
 
-		}
+		// Ends the turn of the side to move: adds its increment and starts the other side
+		void Press();
 
-		void Stop()
-		{
+		void Stop();
 
-		}
+		void Pause();
+		void Resume();
 
-		void Pause()
-		{
+		Duration GetRemainingTime(bool white) const;
+		Duration GetBaseTime(bool white) const { return m_BaseTime[white]; }
+		Duration GetIncrement(bool white) const { return m_Increment[white]; }
 
-		}
+		bool IsWhiteToMove() const { return m_WhiteToMove; }
+		bool IsRunning() const { return m_Running && !m_Paused; }
+		bool IsFlagged(bool white) const { return GetRemainingTime(white) <= Duration::zero(); }
 
-		void Resume()
-		{
-
-		}
+	private:
+		void UpdateRemainingTime();
 
 	private:
+		using TimePoint = std::chrono::steady_clock::time_point;
 
-		
-	};
+		// indexed by bool white
+		std::array<Duration, 2> m_BaseTime{};
+		std::array<Duration, 2> m_Increment{};
+		std::array<Duration, 2> m_RemainingTime{};
+
+		TimePoint m_TurnStart{};
 
+		bool m_WhiteToMove = true;
+		bool m_Running = false;
+		bool m_Paused = false;
+	};
 
-}
+} // namespace ChessCore
@@ -0,0 +1,82 @@
+#include "EPD.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ChessCore
+{
+
+	static bool IsNumber(std::string_view text)
+	{
+		return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+	}
+
+	static bool IsSeparator(char character)
+	{
+		return character == ' ' || character == '\t' || character == '\r';
+	}
+
+	// Value of an EPD operation like "hmvc 12;", empty if the line doesn't have it
+	static std::string_view GetOperation(std::string_view line, std::string_view opcode)
+	{
+		size_t start = line.find(opcode);
+		if (start == std::string_view::npos)
+			return {};
+
+		start += opcode.size();
+		while (start < line.size() && line[start] == ' ')
+			start++;
+
+		size_t end = start;
+		while (end < line.size() && line[end] != ';' && line[end] != ' ')
+			end++;
+		return line.substr(start, end - start);
+	}
+
+	bool EPDToFEN(std::string_view line, std::string& fen)
+	{
+		const std::string_view position = line.substr(0, line.find(','));
+
+		std::vector<std::string_view> fields;
+		size_t index = 0;
+		while (fields.size() < 6)
+		{
+			while (index < position.size() && IsSeparator(position[index]))
+				index++;
+			if (index >= position.size())
+				break;
+
+			size_t end = index;
+			while (end < position.size() && !IsSeparator(position[end]))
+				end++;
+			fields.push_back(position.substr(index, end - index));
+			index = end;
+		}
+
+		if (fields.size() < 4)
+			return false;
+
+		fen.clear();
+		for (size_t i = 0; i < 4; i++)
+		{
+			fen += fields[i];
+			fen += ' ';
+		}
+
+		if (fields.size() == 6 && IsNumber(fields[4]) && IsNumber(fields[5]))
+		{
+			fen += fields[4];
+			fen += ' ';
+			fen += fields[5];
+			return true;
+		}
+
+		const std::string_view halfMoves = GetOperation(position, "hmvc");
+		const std::string_view fullMoves = GetOperation(position, "fmvn");
+		fen += IsNumber(halfMoves) ? halfMoves : "0";
+		fen += ' ';
+		fen += IsNumber(fullMoves) ? fullMoves : "1";
+		return true;
+	}
+
+} // namespace ChessCore
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace ChessCore
+{
+
+	// Full six field FEN from a FEN or EPD line (anything after a comma is ignored, so CSV lines work too).
+	// EPD positions take their clocks from the hmvc / fmvn operations, "0 1" when they don't have them
+	bool EPDToFEN(std::string_view line, std::string& fen);
+
+} // namespace ChessCore
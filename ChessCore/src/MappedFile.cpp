@@ -0,0 +1,161 @@
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace ChessCore
+{
+
+	MappedFile::MappedFile(const std::string& path)
+	{
+		Open(path);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		Swap(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			Close();
+			Swap(other);
+		}
+		return *this;
+	}
+
+#ifdef _WIN32
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data)
+		{
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		m_FileHandle = file;
+		m_MappingHandle = mapping;
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_MappingHandle)
+			CloseHandle(m_MappingHandle);
+		if (m_FileHandle)
+			CloseHandle(m_FileHandle);
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_FileHandle = nullptr;
+		m_MappingHandle = nullptr;
+	}
+
+	void MappedFile::Swap(MappedFile& other) noexcept
+	{
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+		std::swap(m_FileHandle, other.m_FileHandle);
+		std::swap(m_MappingHandle, other.m_MappingHandle);
+	}
+
+#else
+
+	bool MappedFile::Open(const std::string& path)
+	{
+		Close();
+
+		int fileDescriptor = open(path.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+			return false;
+
+		struct stat fileStat {};
+		if (fstat(fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+		{
+			close(fileDescriptor);
+			return false;
+		}
+
+		void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (data == MAP_FAILED)
+		{
+			close(fileDescriptor);
+			return false;
+		}
+
+		m_FileDescriptor = fileDescriptor;
+		m_Data = static_cast<const uint8_t*>(data);
+		m_Size = static_cast<size_t>(fileStat.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if (m_Data)
+			munmap(const_cast<uint8_t*>(m_Data), m_Size);
+		if (m_FileDescriptor >= 0)
+			close(m_FileDescriptor);
+
+		m_Data = nullptr;
+		m_Size = 0;
+		m_FileDescriptor = -1;
+	}
+
+	void MappedFile::Swap(MappedFile& other) noexcept
+	{
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+		std::swap(m_FileDescriptor, other.m_FileDescriptor);
+	}
+
+#endif
+
+} // namespace ChessCore
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace ChessCore
+{
+
+	// Read only memory mapping of a whole file, used for large inputs (models, books, PGN)
+	// so they are paged in by the OS instead of being copied into a buffer
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::string& path);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return m_Data != nullptr; }
+
+		const uint8_t* Data() const { return m_Data; }
+		size_t Size() const { return m_Size; }
+
+		std::string_view View() const { return { reinterpret_cast<const char*>(m_Data), m_Size }; }
+
+	private:
+		void Swap(MappedFile& other) noexcept;
+
+	private:
+		const uint8_t* m_Data = nullptr;
+		size_t m_Size = 0;
+
+#ifdef _WIN32
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#else
+		int m_FileDescriptor = -1;
+#endif
+	};
+
+} // namespace ChessCore
@@ -1089,6 +1089,22 @@ namespace ChessCore
 		}
 	}
 
+	Bitboard MoveGenerator::AttackersTo(const BoardState& board, Square square, Bitboard occupied)
+	{
+		const auto& bb = board.pieceBitboards;
+
+		const Bitboard orthogonalSliders = bb[PieceType::WHITE_ROOK] | bb[PieceType::WHITE_QUEEN] | bb[PieceType::BLACK_ROOK] | bb[PieceType::BLACK_QUEEN];
+		const Bitboard diagonalSliders = bb[PieceType::WHITE_BISHOP] | bb[PieceType::WHITE_QUEEN] | bb[PieceType::BLACK_BISHOP] | bb[PieceType::BLACK_QUEEN];
+
+		// A white pawn attacks square from where a black pawn on square would attack and vice versa
+		return (s_BlackPawnAttackMasks[square] & bb[PieceType::WHITE_PAWN]) |
+			(s_WhitePawnAttackMasks[square] & bb[PieceType::BLACK_PAWN]) |
+			(s_KnightMoveMask[square] & (bb[PieceType::WHITE_KNIGHT] | bb[PieceType::BLACK_KNIGHT])) |
+			(s_KingMoveMask[square] & (bb[PieceType::WHITE_KING] | bb[PieceType::BLACK_KING])) |
+			(GetSlidingAttacks(square, occupied, true) & orthogonalSliders) |
+			(GetSlidingAttacks(square, occupied, false) & diagonalSliders);
+	}
+
 	Piece MoveGenerator::GetPiece(Square square)
 	{
 
@@ -34,8 +34,6 @@ namespace ChessCore
 
 		void GeneratePromotions(Square startSquare, Square targetSquare);
 
-		Bitboard GetSlidingAttacks(Square square, Bitboard blockers, bool orthogonal);
-
 		Piece GetPiece(Square square);
 
 		bool IsPinned(Square square) const;
@@ -97,6 +95,13 @@ namespace ChessCore
 	public:
 		static constexpr uint8_t m_MaxPossibleMoves = 218;
 
+		// Magic lookup of rook (orthogonal) or bishop attacks from square with the given blockers
+		static Bitboard GetSlidingAttacks(Square square, Bitboard blockers, bool orthogonal);
+
+		// Pieces of both colours attacking square, sliders see through squares missing from occupied.
+		// Pieces removed from occupied are still returned, mask the result with occupied to drop them
+		static Bitboard AttackersTo(const BoardState& board, Square square, Bitboard occupied);
+
 		// --------- Members for Precomputing ---------
 
 		// Mask for every square
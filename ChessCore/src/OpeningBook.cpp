@@ -0,0 +1,176 @@
+#include "OpeningBook.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace ChessCore
+{
+
+	static uint64_t ReadBigEndian(const uint8_t* data, size_t bytes)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < bytes; i++)
+			value = (value << 8) | data[i];
+		return value;
+	}
+
+	static void WriteBigEndian(uint8_t* data, uint64_t value, size_t bytes)
+	{
+		for (size_t i = 0; i < bytes; i++)
+			data[i] = static_cast<uint8_t>(value >> ((bytes - 1 - i) * 8));
+	}
+
+	OpeningBook::OpeningBook(const std::string& path)
+	{
+		Open(path);
+	}
+
+	bool OpeningBook::Open(const std::string& path)
+	{
+		if (!m_File.Open(path))
+			return false;
+
+		if (m_File.Size() % c_EntrySize != 0)
+		{
+			std::cout << "Opening book " << path << " is not a multiple of " << c_EntrySize << " bytes" << std::endl;
+			m_File.Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	BookEntry OpeningBook::ReadEntry(size_t index) const
+	{
+		const uint8_t* data = m_File.Data() + index * c_EntrySize;
+
+		BookEntry entry;
+		entry.key = ReadBigEndian(data, 8);
+		entry.move = static_cast<uint16_t>(ReadBigEndian(data + 8, 2));
+		entry.weight = static_cast<uint16_t>(ReadBigEndian(data + 10, 2));
+		entry.learn = static_cast<uint32_t>(ReadBigEndian(data + 12, 4));
+		return entry;
+	}
+
+	std::vector<BookMove> OpeningBook::GetMoves(const ChessBoard& board) const
+	{
+		std::vector<BookMove> moves;
+
+		if (!IsOpen())
+			return moves;
+
+		const uint64_t key = board.GetZobristKey();
+
+		// Binary search for the first entry of the position, its moves are stored next to each other
+		size_t low = 0;
+		size_t high = GetEntryCount();
+		while (low < high)
+		{
+			size_t mid = low + (high - low) / 2;
+			if (ReadBigEndian(m_File.Data() + mid * c_EntrySize, 8) < key)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+
+		for (size_t i = low; i < GetEntryCount(); i++)
+		{
+			BookEntry entry = ReadEntry(i);
+			if (entry.key != key)
+				break;
+
+			// A key collision or a corrupt entry can give a move that isn't legal here
+			Move move = DecodeMove(board, entry.move);
+			if (move != 0)
+				moves.push_back({ move, entry.weight });
+		}
+
+		return moves;
+	}
+
+	Move OpeningBook::GetWeightedMove(const ChessBoard& board, std::mt19937_64& rng) const
+	{
+		std::vector<BookMove> moves = GetMoves(board);
+
+		uint32_t totalWeight = 0;
+		for (const BookMove& bookMove : moves)
+			totalWeight += bookMove.weight;
+
+		if (totalWeight == 0)
+			return 0;
+
+		uint32_t pick = std::uniform_int_distribution<uint32_t>(0, totalWeight - 1)(rng);
+		for (const BookMove& bookMove : moves)
+		{
+			if (pick < bookMove.weight)
+				return bookMove.move;
+			pick -= bookMove.weight;
+		}
+
+		return 0;
+	}
+
+	uint16_t OpeningBook::EncodeMove(Move move)
+	{
+		Square start = move.GetStartSquare();
+		Square target = move.GetTargetSquare();
+
+		// Castling is stored as the king capturing its own rook
+		if (move.GetMoveFlags() & MoveFlags::IS_CASTLES)
+			target = Square(target % 8 == 6 ? 7 : 0, target / 8);
+
+		uint16_t promo = 0;
+		if (move.GetMoveFlags() & MoveFlags::IS_PROMOTION)
+			promo = move.GetPromoPiece() % 6; // knight 1, bishop 2, rook 3, queen 4
+
+		return static_cast<uint16_t>(
+			(target % 8) |
+			((target / 8) << 3) |
+			((start % 8) << 6) |
+			((start / 8) << 9) |
+			(promo << 12));
+	}
+
+	Move OpeningBook::DecodeMove(const ChessBoard& board, uint16_t bookMove)
+	{
+		for (Move move : board.GetLegalMoves())
+		{
+			if (EncodeMove(move) == bookMove)
+				return move;
+		}
+
+		return 0;
+	}
+
+	bool OpeningBook::Write(const std::string& path, std::vector<BookEntry> entries)
+	{
+		std::sort(entries.begin(), entries.end(), [](const BookEntry& a, const BookEntry& b)
+			{
+				if (a.key != b.key)
+					return a.key < b.key;
+				return a.weight > b.weight;
+			});
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "Could not open " << path << " for writing" << std::endl;
+			return false;
+		}
+
+		std::vector<uint8_t> buffer(entries.size() * c_EntrySize);
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			uint8_t* data = buffer.data() + i * c_EntrySize;
+			WriteBigEndian(data, entries[i].key, 8);
+			WriteBigEndian(data + 8, entries[i].move, 2);
+			WriteBigEndian(data + 10, entries[i].weight, 2);
+			WriteBigEndian(data + 12, entries[i].learn, 4);
+		}
+
+		file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+		return file.good();
+	}
+
+} // namespace ChessCore
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "MappedFile.h"
+
+namespace ChessCore
+{
+
+	// One book move, laid out like a Polyglot .bin entry (16 bytes, big endian on disk).
+	// The key is ChessBoard::GetZobristKey, not the Polyglot hash, so Polyglot books don't match
+	struct BookEntry
+	{
+		uint64_t key = 0;
+		uint16_t move = 0;   // to file, to rank, from file, from rank, promotion, 3 bits each
+		uint16_t weight = 0;
+		uint32_t learn = 0;
+	};
+
+	struct BookMove
+	{
+		Move move = 0;
+		uint16_t weight = 0;
+	};
+
+	// Read only opening book, entries sorted by key and memory mapped so a probe is a binary search
+	class OpeningBook
+	{
+	public:
+		OpeningBook() = default;
+		explicit OpeningBook(const std::string& path);
+
+		bool Open(const std::string& path);
+		void Close() { m_File.Close(); }
+
+		bool IsOpen() const { return m_File.IsOpen(); }
+		size_t GetEntryCount() const { return m_File.Size() / c_EntrySize; }
+
+		// All legal book moves for the position with their weights
+		std::vector<BookMove> GetMoves(const ChessBoard& board) const;
+
+		// Picks a book move with a probability proportional to its weight, 0 if the position isn't in the book
+		Move GetWeightedMove(const ChessBoard& board, std::mt19937_64& rng) const;
+
+		static uint16_t EncodeMove(Move move);
+		// Finds the legal move matching an encoded book move, 0 if there is none
+		static Move DecodeMove(const ChessBoard& board, uint16_t bookMove);
+
+		// Sorts the entries by key and writes them in the on disk layout
+		static bool Write(const std::string& path, std::vector<BookEntry> entries);
+
+		static constexpr size_t c_EntrySize = 16;
+
+	private:
+		BookEntry ReadEntry(size_t index) const;
+
+	private:
+		MappedFile m_File;
+	};
+
+} // namespace ChessCore
@@ -0,0 +1,302 @@
+#include "PGN.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace ChessCore
+{
+
+	static bool IsWhitespace(char character)
+	{
+		return character == ' ' || character == '\n' || character == '\r' || character == '\t';
+	}
+
+	static bool IsResultToken(std::string_view token)
+	{
+		return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+	}
+
+	bool PGNMoveTokenizer::Next(std::string_view& san)
+	{
+		const std::string_view text = m_MoveText;
+
+		while (m_Position < text.size())
+		{
+			const char character = text[m_Position];
+
+			if (IsWhitespace(character))
+			{
+				m_Position++;
+				continue;
+			}
+
+			if (character == '{')
+			{
+				size_t end = text.find('}', m_Position);
+				m_Position = end == std::string_view::npos ? text.size() : end + 1;
+				continue;
+			}
+
+			if (character == ';')
+			{
+				size_t end = text.find('\n', m_Position);
+				m_Position = end == std::string_view::npos ? text.size() : end + 1;
+				continue;
+			}
+
+			if (character == '(')
+			{
+				int nesting = 0;
+				for (; m_Position < text.size(); m_Position++)
+				{
+					if (text[m_Position] == '(')
+						nesting++;
+					else if (text[m_Position] == ')' && --nesting == 0)
+						break;
+				}
+				m_Position++;
+				continue;
+			}
+
+			size_t tokenEnd = m_Position;
+			while (tokenEnd < text.size() && !IsWhitespace(text[tokenEnd]) && text[tokenEnd] != '{' && text[tokenEnd] != '(' && text[tokenEnd] != ';')
+				tokenEnd++;
+
+			std::string_view token = text.substr(m_Position, tokenEnd - m_Position);
+			m_Position = tokenEnd;
+
+			if (token[0] == '$' || token[0] == ')')
+				continue;
+
+			if (IsResultToken(token))
+			{
+				m_Position = text.size();
+				return false;
+			}
+
+			// Move numbers, possibly glued to the move ("12.e4", "12...Nf6"), "0-0" is castling though
+			if (token.substr(0, 3) != "0-0")
+			{
+				while (!token.empty() && ((token[0] >= '0' && token[0] <= '9') || token[0] == '.'))
+					token.remove_prefix(1);
+
+				if (token.empty())
+					continue;
+			}
+
+			san = token;
+			return true;
+		}
+
+		return false;
+	}
+
+	std::string_view PGNGame::GetTag(std::string_view name) const
+	{
+		std::string_view result;
+		ForEachTag([&](std::string_view tagName, std::string_view value)
+			{
+				if (result.empty() && tagName == name)
+					result = value;
+			});
+		return result;
+	}
+
+	PGNReader::PGNReader(const std::string& path)
+	{
+		Open(path);
+	}
+
+	bool PGNReader::Open(const std::string& path)
+	{
+		m_Position = 0;
+
+		if (!m_File.Open(path))
+		{
+			m_Data = {};
+			return false;
+		}
+
+		m_Data = m_File.View();
+		return true;
+	}
+
+	bool PGNReader::NextGame(PGNGame& game)
+	{
+		const std::string_view data = m_Data;
+
+		// A game is its tag section followed by the move text, which runs until the next tag line
+		while (m_Position < data.size())
+		{
+			size_t tagStart = data.find('[', m_Position);
+			if (tagStart == std::string_view::npos)
+			{
+				m_Position = data.size();
+				return false;
+			}
+
+			size_t tagEnd = tagStart;
+			while (tagEnd < data.size() && data[tagEnd] == '[')
+			{
+				tagEnd = data.find('\n', tagEnd);
+				tagEnd = tagEnd == std::string_view::npos ? data.size() : tagEnd + 1;
+
+				while (tagEnd < data.size() && (data[tagEnd] == ' ' || data[tagEnd] == '\t' || data[tagEnd] == '\r'))
+					tagEnd++;
+			}
+
+			size_t moveTextEnd = data.find("\n[", tagEnd);
+			moveTextEnd = moveTextEnd == std::string_view::npos ? data.size() : moveTextEnd + 1;
+
+			game.tagSection = data.substr(tagStart, tagEnd - tagStart);
+			game.moveText = data.substr(tagEnd, moveTextEnd - tagEnd);
+			m_Position = moveTextEnd;
+			return true;
+		}
+
+		return false;
+	}
+
+	std::vector<std::string_view> PGNReader::SplitIntoChunks(std::string_view data, size_t chunkCount)
+	{
+		std::vector<size_t> starts{ 0 };
+		for (size_t i = 1; i < chunkCount; i++)
+		{
+			size_t start = data.find("\n[Event ", std::max(starts.back(), data.size() * i / chunkCount));
+			if (start == std::string_view::npos)
+				break;
+			starts.push_back(start + 1);
+		}
+		starts.push_back(data.size());
+
+		std::vector<std::string_view> chunks;
+		for (size_t i = 0; i + 1 < starts.size(); i++)
+			chunks.push_back(data.substr(starts[i], starts[i + 1] - starts[i]));
+		return chunks;
+	}
+
+	PGNWriter::PGNWriter(const ChessBoard& startBoard)
+		: m_Board(startBoard)
+	{
+		m_Tags = {
+			{ "Event", "?" },
+			{ "Site", "?" },
+			{ "Date", "????.??.??" },
+			{ "Round", "?" },
+			{ "White", "?" },
+			{ "Black", "?" },
+			{ "Result", "*" },
+		};
+
+		const std::string fen = startBoard.GetFENString();
+		if (fen != ChessBoard().GetFENString())
+		{
+			SetTag("SetUp", "1");
+			SetTag("FEN", fen);
+		}
+	}
+
+	void PGNWriter::SetTag(std::string_view name, std::string_view value)
+	{
+		for (auto& [tagName, tagValue] : m_Tags)
+		{
+			if (tagName == name)
+			{
+				tagValue = value;
+				return;
+			}
+		}
+
+		m_Tags.emplace_back(name, value);
+	}
+
+	void PGNWriter::AddMove(Move move, std::optional<Clock::Duration> clock)
+	{
+		const bool whiteToMove = m_Board.GetBoardState().HasFlag(BoardStateFlags::WhiteToMove);
+		if (whiteToMove)
+			m_MoveTokens.push_back(std::to_string(m_Board.GetFullMoveClock()) + ".");
+		else if (m_MoveTokens.empty())
+			m_MoveTokens.push_back(std::to_string(m_Board.GetFullMoveClock()) + "...");
+
+		m_MoveTokens.push_back(m_Board.ToSAN(move));
+
+		if (clock)
+		{
+			const int64_t seconds = std::max<int64_t>(std::chrono::duration_cast<std::chrono::seconds>(*clock).count(), 0);
+
+			char comment[32];
+			std::snprintf(comment, sizeof(comment), "{ [%%clk %lld:%02lld:%02lld] }", (long long)(seconds / 3600), (long long)(seconds / 60 % 60), (long long)(seconds % 60));
+			m_MoveTokens.push_back(comment);
+		}
+
+		// A game move, so a long game doesn't fill the board's undo stack
+		m_Board.MakeMove(move, true);
+	}
+
+	void PGNWriter::SetResult(std::string_view result)
+	{
+		m_Result = result;
+		SetTag("Result", result);
+	}
+
+	std::string PGNWriter::ToString() const
+	{
+		std::string pgn;
+
+		for (const auto& [name, value] : m_Tags)
+		{
+			pgn += "[" + name + " \"";
+			for (char character : value)
+			{
+				if (character == '"' || character == '\\')
+					pgn += '\\';
+				pgn += character;
+			}
+			pgn += "\"]\n";
+		}
+		pgn += '\n';
+
+		size_t lineLength = 0;
+		auto append = [&](const std::string& token)
+			{
+				if (lineLength > 0 && lineLength + 1 + token.size() > c_MaxLineLength)
+				{
+					pgn += '\n';
+					lineLength = 0;
+				}
+				else if (lineLength > 0)
+				{
+					pgn += ' ';
+					lineLength++;
+				}
+
+				pgn += token;
+				lineLength += token.size();
+			};
+
+		for (const std::string& token : m_MoveTokens)
+			append(token);
+		append(m_Result);
+
+		pgn += "\n\n";
+		return pgn;
+	}
+
+	bool PGNWriter::AppendToFile(const std::string& path) const
+	{
+		std::error_code error;
+		const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+		if (!directory.empty())
+			std::filesystem::create_directories(directory, error);
+
+		std::ofstream file(path, std::ios::app | std::ios::binary);
+		if (!file.is_open())
+			return false;
+
+		file << ToString();
+		return file.good();
+	}
+
+} // namespace ChessCore
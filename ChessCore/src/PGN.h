@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "Clock.h"
+#include "MappedFile.h"
+#include "Move.h"
+
+namespace ChessCore
+{
+
+	// Walks the main line of a move text and returns the SAN tokens one by one.
+	// Comments, variations, annotation glyphs, move numbers and the result are skipped
+	class PGNMoveTokenizer
+	{
+	public:
+		explicit PGNMoveTokenizer(std::string_view moveText) : m_MoveText(moveText) {}
+
+		// False once the move text is exhausted
+		bool Next(std::string_view& san);
+
+	private:
+		std::string_view m_MoveText;
+		size_t m_Position = 0;
+	};
+
+	// One game of a PGN, both parts are views into the reader's data
+	struct PGNGame
+	{
+		std::string_view tagSection;
+		std::string_view moveText;
+
+		// Value of a tag, empty if the game doesn't have it
+		std::string_view GetTag(std::string_view name) const;
+
+		// Calls callback(name, value) for every tag in file order
+		template<typename TCallback>
+		void ForEachTag(TCallback&& callback) const;
+
+		PGNMoveTokenizer GetMoves() const { return PGNMoveTokenizer(moveText); }
+	};
+
+	// Streams the games of a PGN without copying, either from a mapped file or from a view into memory
+	// (one chunk of a file that is split up between threads with SplitIntoChunks)
+	class PGNReader
+	{
+	public:
+		PGNReader() = default;
+		explicit PGNReader(const std::string& path);
+		explicit PGNReader(const char* path) : PGNReader(std::string(path)) {}
+		explicit PGNReader(std::string_view data) : m_Data(data) {}
+
+		bool Open(const std::string& path);
+		bool IsOpen() const { return m_Data.data() != nullptr; }
+
+		std::string_view GetData() const { return m_Data; }
+		size_t GetPosition() const { return m_Position; }
+
+		// False when there are no more games
+		bool NextGame(PGNGame& game);
+
+		// Splits PGN data into about equally sized chunks that each start at an [Event tag
+		static std::vector<std::string_view> SplitIntoChunks(std::string_view data, size_t chunkCount);
+
+	private:
+		MappedFile m_File;
+		std::string_view m_Data;
+		size_t m_Position = 0;
+	};
+
+	// Records a game move by move and exports it as PGN, with the mover's clock after every move
+	class PGNWriter
+	{
+	public:
+		explicit PGNWriter(const ChessBoard& startBoard = ChessBoard());
+
+		// Replaces the tag if it is already set, the seven tag roster is always there
+		void SetTag(std::string_view name, std::string_view value);
+
+		// The move has to be legal in the current position of the recorded game, clock is the mover's time
+		// after the move including the increment, written as a %clk comment
+		void AddMove(Move move, std::optional<Clock::Duration> clock = std::nullopt);
+
+		// "1-0", "0-1", "1/2-1/2" or "*"
+		void SetResult(std::string_view result);
+
+		std::string ToString() const;
+		bool AppendToFile(const std::string& path) const;
+
+	private:
+		ChessBoard m_Board;
+		std::vector<std::pair<std::string, std::string>> m_Tags;
+		std::vector<std::string> m_MoveTokens;
+		std::string m_Result = "*";
+
+		static constexpr size_t c_MaxLineLength = 80;
+	};
+
+	template<typename TCallback>
+	void PGNGame::ForEachTag(TCallback&& callback) const
+	{
+		size_t lineStart = 0;
+		while (lineStart < tagSection.size())
+		{
+			size_t lineEnd = tagSection.find('\n', lineStart);
+			if (lineEnd == std::string_view::npos)
+				lineEnd = tagSection.size();
+
+			std::string_view line = tagSection.substr(lineStart, lineEnd - lineStart);
+			lineStart = lineEnd + 1;
+
+			size_t nameEnd = line.find(' ');
+			size_t valueStart = line.find('"');
+			size_t valueEnd = line.rfind('"');
+			if (line.empty() || line[0] != '[' || nameEnd == std::string_view::npos || valueStart == std::string_view::npos || valueEnd <= valueStart)
+				continue;
+
+			callback(line.substr(1, nameEnd - 1), line.substr(valueStart + 1, valueEnd - valueStart - 1));
+		}
+	}
+
+} // namespace ChessCore
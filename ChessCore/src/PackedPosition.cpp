@@ -0,0 +1,101 @@
+#include "PackedPosition.h"
+
+#include <algorithm>
+
+namespace ChessCore
+{
+
+	static constexpr char c_PieceLetters[] = "PNBRQKpnbrqk";
+
+	bool PackedPosition::Encode(const ChessBoard& board, int score, TrainingResult result, PackedPosition& packed)
+	{
+		const BoardState& boardState = board.GetBoardState();
+
+		packed = PackedPosition();
+
+		for (uint8_t piece = PieceType::WHITE_PAWN; piece <= PieceType::BLACK_KING; piece++)
+			packed.occupancy |= boardState.pieceBitboards[piece];
+
+		if (BitUtil::PopCnt(packed.occupancy) > 32)
+			return false;
+
+		Bitboard remaining = packed.occupancy;
+		for (uint8_t index = 0; remaining; index++)
+		{
+			const uint8_t square = BitUtil::PopLSB(remaining);
+			packed.pieces[index >> 1] |= static_cast<uint8_t>(board.GetPiece(square) << ((index & 1) * 4));
+		}
+
+		packed.flags = boardState.boardStateFlags;
+		packed.enPassantFile = boardState.enPassantFile;
+		packed.halfMoveClock = board.GetHalfMoveClock();
+		packed.result = result;
+		packed.score = static_cast<int16_t>(std::clamp(score, INT16_MIN, INT16_MAX));
+		packed.fullMoveNumber = board.GetFullMoveClock();
+		return true;
+	}
+
+	std::string PackedPosition::ToFEN() const
+	{
+		std::array<char, 64> squares;
+		squares.fill(0);
+		ForEachPiece([&](uint8_t square, uint8_t piece)
+			{
+				if (piece <= PieceType::BLACK_KING)
+					squares[square] = c_PieceLetters[piece];
+			});
+
+		std::string fen;
+		fen.reserve(90);
+
+		for (int rank = 7; rank >= 0; rank--)
+		{
+			char emptyCount = 0;
+			for (int file = 0; file < 8; file++)
+			{
+				const char letter = squares[rank * 8 + file];
+				if (!letter)
+				{
+					emptyCount++;
+					continue;
+				}
+
+				if (emptyCount)
+					fen.push_back('0' + emptyCount);
+				emptyCount = 0;
+				fen.push_back(letter);
+			}
+
+			if (emptyCount)
+				fen.push_back('0' + emptyCount);
+			if (rank > 0)
+				fen.push_back('/');
+		}
+
+		const bool whiteToMove = flags & BoardStateFlags::WhiteToMove;
+		fen += whiteToMove ? " w " : " b ";
+
+		const size_t castlingStart = fen.size();
+		if (flags & BoardStateFlags::CanWhiteCastleKing) fen.push_back('K');
+		if (flags & BoardStateFlags::CanWhiteCastleQueen) fen.push_back('Q');
+		if (flags & BoardStateFlags::CanBlackCastleKing) fen.push_back('k');
+		if (flags & BoardStateFlags::CanBlackCastleQueen) fen.push_back('q');
+		if (fen.size() == castlingStart)
+			fen.push_back('-');
+
+		fen.push_back(' ');
+		if ((flags & BoardStateFlags::CanEnPassent) && enPassantFile <= 7)
+		{
+			fen.push_back('a' + enPassantFile);
+			fen.push_back(whiteToMove ? '6' : '3');
+		}
+		else
+		{
+			fen.push_back('-');
+		}
+
+		fen += " " + std::to_string(halfMoveClock) + " " + std::to_string(fullMoveNumber);
+		return fen;
+	}
+
+} // namespace ChessCore
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "ChessBoard.h"
+#include "ChessUtil.h"
+
+namespace ChessCore
+{
+
+	// Game result from white's point of view
+	enum TrainingResult : uint8_t
+	{
+		BLACK_WIN = 0,
+		DRAW = 1,
+		WHITE_WIN = 2,
+		UNKNOWN_RESULT = 3,
+	};
+
+	// One training position in 32 bytes, written to disk as is (little endian, the workspace is x64 only).
+	// The pieces are 4 bit PieceTypes in the order of the set bits of the occupancy, low nibble first
+	struct PackedPosition
+	{
+		Bitboard occupancy = 0;
+		std::array<uint8_t, 16> pieces{};
+		uint8_t flags = 0;			// BoardStateFlags
+		uint8_t enPassantFile = 8;
+		uint8_t halfMoveClock = 0;
+		uint8_t result = TrainingResult::UNKNOWN_RESULT;
+		int16_t score = 0;			// centipawns from white's point of view
+		uint16_t fullMoveNumber = 1;
+
+		// False if the board has more than 32 pieces, the score is clamped to 16 bits
+		static bool Encode(const ChessBoard& board, int score, TrainingResult result, PackedPosition& packed);
+
+		// Calls callback(square, piece) for every piece from a1 to h8
+		template<typename TCallback>
+		void ForEachPiece(TCallback&& callback) const;
+
+		std::string ToFEN() const;
+		ChessBoard ToBoard() const { return ChessBoard(ToFEN()); }
+	};
+
+	static_assert(sizeof(PackedPosition) == 32, "PackedPosition is a 32 byte on disk record");
+
+	template<typename TCallback>
+	void PackedPosition::ForEachPiece(TCallback&& callback) const
+	{
+		Bitboard remaining = occupancy;
+		for (uint8_t index = 0; remaining; index++)
+		{
+			const uint8_t square = BitUtil::PopLSB(remaining);
+			const uint8_t piece = (pieces[index >> 1] >> ((index & 1) * 4)) & 0xF;
+			callback(square, piece);
+		}
+	}
+
+} // namespace ChessCore
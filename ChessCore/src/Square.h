@@ -9,13 +9,15 @@ namespace ChessCore
 
 	struct Square
 	{
-		Square() = default;
-		Square(uint8_t file, uint8_t rank) { square = file + rank * 8; };
-		Square(uint8_t s) : square(s) {}
+		// constexpr so the named squares below are constant initialized,
+		// other translation units build static masks from them
+		constexpr Square() = default;
+		constexpr Square(uint8_t file, uint8_t rank) : square(file + rank * 8) {}
+		constexpr Square(uint8_t s) : square(s) {}
 
 		uint8_t square{ 0 };
 
-		operator uint8_t() const { return square; }
+		constexpr operator uint8_t() const { return square; }
 
 		Square& operator++()
 		{
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+#include "Piece.h"
+#include "Square.h"
+#include "BoardState.h"
+
+namespace ChessCore
+{
+
+	// Material + piece square table score (PeSTO values), kept up to date by
+	// ChessBoard::MakeMove / UndoMove so reading it costs nothing
+	struct StaticEval
+	{
+		int16_t midGame = 0; // white relative, centipawns
+		int16_t endGame = 0; // white relative, centipawns
+		uint8_t phase = 0;   // 0 = pawns and kings only, 24 = all minor and major pieces on the board
+
+		void AddPiece(Piece piece, Square square)
+		{
+			midGame += s_MidGameTable[piece][square];
+			endGame += s_EndGameTable[piece][square];
+			phase += s_PhaseWeights[piece];
+		}
+
+		void RemovePiece(Piece piece, Square square)
+		{
+			midGame -= s_MidGameTable[piece][square];
+			endGame -= s_EndGameTable[piece][square];
+			phase -= s_PhaseWeights[piece];
+		}
+
+		// Blends mid and end game score by phase, white relative centipawns
+		int32_t GetTapered() const
+		{
+			const int32_t mgPhase = phase < c_MaxPhase ? phase : c_MaxPhase;
+			return (midGame * mgPhase + endGame * (c_MaxPhase - mgPhase)) / c_MaxPhase;
+		}
+
+		bool operator==(const StaticEval& other) const = default;
+
+		static StaticEval Calculate(const BoardState& boardState);
+
+		static constexpr int32_t c_MaxPhase = 24;
+
+		static constexpr std::array<int16_t, 6> s_MidGamePieceValues = { 82, 337, 365, 477, 1025, 0 };
+		static constexpr std::array<int16_t, 6> s_EndGamePieceValues = { 94, 281, 297, 512, 936, 0 };
+
+		static constexpr std::array<uint8_t, 12> s_PhaseWeights = { 0, 1, 1, 2, 4, 0, 0, 1, 1, 2, 4, 0 };
+
+		// Signed piece value + square bonus for every piece and square, a1 = 0
+		static const std::array<std::array<int16_t, 64>, 12> s_MidGameTable;
+		static const std::array<std::array<int16_t, 64>, 12> s_EndGameTable;
+
+	private:
+
+		static std::array<std::array<int16_t, 64>, 12> InitTable(
+			const std::array<std::array<int16_t, 64>, 6>& pieceSquareTables,
+			const std::array<int16_t, 6>& pieceValues);
+
+		// From white's point of view, written as seen from white (a8 is index 0)
+		static const std::array<std::array<int16_t, 64>, 6> s_MidGamePieceSquareTables;
+		static const std::array<std::array<int16_t, 64>, 6> s_EndGamePieceSquareTables;
+	};
+
+} // namespace ChessCore
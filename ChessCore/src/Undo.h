@@ -3,6 +3,9 @@
 #include <cstdint>
 #include <array>
 
+#include "Piece.h"
+#include "StaticEval.h"
+
 namespace ChessCore
 {
 
@@ -12,6 +15,7 @@ namespace ChessCore
         uint8_t castlingRights; // old castling rights
         uint8_t  enPassantFile;// old en passant square, -1 if none
         uint8_t halfmoveClock; // for 50-move rule
+        StaticEval staticEval; // material and piece square score before the move
     };
 
     struct UndoStack 
@@ -3,7 +3,9 @@
 namespace ChessCore
 {
 
-    std::mt19937_64 Zobrist::rng(std::random_device{}());
+    // Fixed seed, the keys are stored in opening books so they have to be the same in every run.
+    // Changing the seed or the order the tables below are filled in invalidates existing books
+    std::mt19937_64 Zobrist::rng(0x4E657261436865ULL);
 
     template<size_t Size>
     std::array<uint64_t, Size> Zobrist::GetRandomArray()
@@ -0,0 +1,56 @@
+project "DataConverter"
+  kind "ConsoleApp"
+  language "C++"
+  cppdialect "C++23"
+  targetdir ("../bin/%{cfg.buildcfg}/%{prj.name}")
+  objdir ("../bin/Intermediates/%{cfg.buildcfg}/%{prj.name}")
+  staticruntime "off"
+
+  files
+  {
+    "src/**.cpp",
+    "src/**.h",
+  }
+
+  includedirs
+  {
+    "src",
+
+    "../ChessCore/src",
+  }
+
+  links
+  {
+    "ChessCore",
+  }
+
+  -- Platform
+
+  filter "system:windows"
+    systemversion "latest"
+    defines { "WINDOWS" }
+
+  filter "system:linux"
+    links { "pthread" }
+  filter {}
+
+  -- Configurations
+
+  filter "configurations:Debug"
+    defines { "DEBUG" }
+    runtime "Debug"
+    symbols "On"
+
+  filter "configurations:Release"
+    defines { "RELEASE" }
+    runtime "Release"
+    optimize "On"
+    symbols "On"
+
+  filter "configurations:Dist"
+    defines { "DIST" }
+    runtime "Release"
+    optimize "On"
+    symbols "Off"
+
+  filter {}
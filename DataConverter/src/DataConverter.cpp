@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "MappedFile.h"
+#include "PackedPosition.h"
+
+// Converts "fen,score[,result]" training CSVs (CreateDataSet.py, DataGen) into 32 byte PackedPosition records.
+// The CSV is memory mapped and converted block by block, every block is split between the threads at line
+// boundaries and the records are written in input order
+
+struct ConverterSettings
+{
+	std::string inputPath;
+	std::string outputPath;
+	uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+};
+
+static constexpr size_t c_BlockSize = 64ull << 20;	// bytes of CSV per round
+static constexpr int c_MateScore = 10000;			// "#+3" style scores, same value CreateDataSet.py uses for mates
+
+static std::string_view NextField(std::string_view& line)
+{
+	const size_t comma = line.find(',');
+	std::string_view field = line.substr(0, comma);
+	line = comma == std::string_view::npos ? std::string_view() : line.substr(comma + 1);
+
+	while (!field.empty() && (field.front() == ' ' || field.front() == '"'))
+		field.remove_prefix(1);
+	while (!field.empty() && (field.back() == ' ' || field.back() == '"' || field.back() == '\r'))
+		field.remove_suffix(1);
+	return field;
+}
+
+static bool ParseScore(std::string_view text, int& score)
+{
+	const bool isMate = !text.empty() && text.front() == '#';
+	if (isMate)
+		text.remove_prefix(1);
+	if (!text.empty() && text.front() == '+')
+		text.remove_prefix(1);
+
+	int value = 0;
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (error != std::errc() || text.empty())
+		return false;
+
+	score = isMate ? (value < 0 ? -c_MateScore : c_MateScore) : value;
+	return true;
+}
+
+static ChessCore::TrainingResult ParseResult(std::string_view text)
+{
+	if (text == "1" || text == "1-0")
+		return ChessCore::TrainingResult::WHITE_WIN;
+	if (text == "0.5" || text == "1/2-1/2")
+		return ChessCore::TrainingResult::DRAW;
+	if (text == "0" || text == "0-1")
+		return ChessCore::TrainingResult::BLACK_WIN;
+	return ChessCore::TrainingResult::UNKNOWN_RESULT;
+}
+
+// Converts every line of the chunk, lines that don't parse (a header, broken FENs) are counted and skipped
+static void ConvertChunk(std::string_view chunk, std::vector<ChessCore::PackedPosition>& records, std::atomic<uint64_t>& skipped)
+{
+	records.clear();
+	records.reserve(chunk.size() / 64);
+
+	uint64_t skippedLines = 0;
+	size_t lineStart = 0;
+	while (lineStart < chunk.size())
+	{
+		size_t lineEnd = chunk.find('\n', lineStart);
+		if (lineEnd == std::string_view::npos)
+			lineEnd = chunk.size();
+
+		std::string_view line = chunk.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		if (line.empty() || line == "\r")
+			continue;
+
+		const std::string_view fen = NextField(line);
+		const std::string_view scoreText = NextField(line);
+		const std::string_view resultText = NextField(line);
+
+		int score = 0;
+		if (fen.empty() || !ParseScore(scoreText, score))
+		{
+			skippedLines++;
+			continue;
+		}
+
+		ChessCore::ChessBoard board{ std::string(fen) };
+		ChessCore::PackedPosition record;
+		if (board.GetError() || !ChessCore::PackedPosition::Encode(board, score, ParseResult(resultText), record))
+		{
+			skippedLines++;
+			continue;
+		}
+
+		records.push_back(record);
+	}
+
+	skipped.fetch_add(skippedLines, std::memory_order_relaxed);
+}
+
+// Splits data into about equally sized pieces that end at a newline
+static std::vector<std::string_view> SplitAtLines(std::string_view data, size_t chunkCount)
+{
+	std::vector<std::string_view> chunks;
+	size_t start = 0;
+	for (size_t i = 1; i <= chunkCount && start < data.size(); i++)
+	{
+		size_t end = i == chunkCount ? data.size() : std::max(start, data.size() * i / chunkCount);
+		end = data.find('\n', end);
+		end = end == std::string_view::npos ? data.size() : end + 1;
+
+		chunks.push_back(data.substr(start, end - start));
+		start = end;
+	}
+	return chunks;
+}
+
+static bool ParseArguments(int argc, char** argv, ConverterSettings& settings)
+{
+	std::vector<std::string_view> positional;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--threads" && hasValue)
+			settings.threadCount = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument.substr(0, 2) == "--")
+			return false;
+		else
+			positional.push_back(argument);
+	}
+
+	if (positional.size() != 2)
+		return false;
+
+	settings.inputPath = positional[0];
+	settings.outputPath = positional[1];
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	ConverterSettings settings;
+	if (!ParseArguments(argc, argv, settings))
+	{
+		std::cout << "Usage: DataConverter <positions.csv> <positions.bin> [--threads n]" << std::endl;
+		return 1;
+	}
+
+	ChessCore::MappedFile input(settings.inputPath);
+	if (!input.IsOpen())
+	{
+		std::cout << "Could not open " << settings.inputPath << std::endl;
+		return 1;
+	}
+
+	std::ofstream output(settings.outputPath, std::ios::binary | std::ios::trunc);
+	if (!output.is_open())
+	{
+		std::cout << "Could not open " << settings.outputPath << std::endl;
+		return 1;
+	}
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<std::vector<ChessCore::PackedPosition>> records(settings.threadCount);
+	std::atomic<uint64_t> skipped = 0;
+	uint64_t written = 0;
+
+	const std::string_view data = input.View();
+	for (std::string_view block : SplitAtLines(data, std::max<size_t>(data.size() / c_BlockSize, 1)))
+	{
+		const std::vector<std::string_view> chunks = SplitAtLines(block, settings.threadCount);
+
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < chunks.size(); i++)
+			workers.emplace_back(ConvertChunk, chunks[i], std::ref(records[i]), std::ref(skipped));
+
+		for (std::thread& worker : workers)
+			worker.join();
+
+		for (size_t i = 0; i < chunks.size(); i++)
+		{
+			output.write(reinterpret_cast<const char*>(records[i].data()), records[i].size() * sizeof(ChessCore::PackedPosition));
+			written += records[i].size();
+		}
+	}
+
+	if (!output.good())
+	{
+		std::cout << "Could not write " << settings.outputPath << std::endl;
+		return 1;
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Wrote " << written << " positions (" << skipped << " lines skipped) to " << settings.outputPath
+		<< " in " << seconds << "s" << std::endl;
+
+	return 0;
+}
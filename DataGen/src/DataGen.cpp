@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "Clock.h"
+
+#include "ChessPlayers/Bots/NeraChessBot.h"
+
+// Self-play training data generator, replaces ChessAITrainingStuff/scripts/CreateDataSet.py.
+// Every thread plays its own games with NeraChessBot at a fixed node count from a few random opening moves
+// and writes the quiet positions of each finished game as "fen,score,result" lines, the score in centipawns and
+// the result as 1 / 0.5 / 0, both from white's point of view
+
+struct GeneratorSettings
+{
+	std::string outputPath;
+	uint64_t positionCount = 1'000'000;
+	uint64_t nodes = 5'000;
+	uint32_t randomPlies = 8;
+	uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	size_t hashMegabytes = 16;
+	std::string modelPath; // classical eval when empty
+	uint64_t seed = std::random_device{}();
+};
+
+struct SharedState
+{
+	std::mutex outputMutex;
+	std::ofstream output;
+
+	std::atomic<uint64_t> positions = 0;
+	std::atomic<uint64_t> games = 0;
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+static constexpr uint32_t c_MaxGamePlies = 240;		// longer games are drawn, they are mostly shuffling in dead endgames
+static constexpr int c_AdjudicationScore = 1500;	// a side this far ahead for c_AdjudicationPlies plies in a row wins
+static constexpr uint32_t c_AdjudicationPlies = 6;
+static constexpr uint64_t c_ProgressInterval = 100'000;
+
+// Plays one game and returns its lines, empty if the random opening already ended the game
+static std::string PlayGame(NeraChessBot& bot, const GeneratorSettings& settings, std::mt19937_64& rng)
+{
+	ChessCore::ChessBoard board;
+
+	// Random moves for diversity, an odd or even count so both colours get the first searched move
+	const uint32_t randomPlies = settings.randomPlies + (uint32_t)(rng() % 2);
+	for (uint32_t ply = 0; ply < randomPlies; ply++)
+	{
+		ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
+		if (legalMoves.size() == 0)
+			return {};
+
+		board.MakeMove(legalMoves[rng() % legalMoves.size()], true);
+	}
+
+	if (board.GetGameOver(true) & ChessCore::GameOverFlags::IS_GAME_OVER)
+		return {};
+
+	bot.ResetGame();
+
+	// No time limit, the node limit ends every search
+	const ChessCore::Clock clock(std::chrono::hours(24), ChessCore::Clock::Duration::zero());
+
+	std::vector<std::pair<std::string, int>> positions;
+	const char* result = "0.5";
+	uint32_t adjudicationCount = 0;
+	int adjudicationSign = 0;
+
+	for (uint32_t ply = 0; ply < c_MaxGamePlies; ply++)
+	{
+		const bool whiteToMove = board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove);
+
+		const uint16_t gameOverFlags = board.GetGameOver(true);
+		if (gameOverFlags & ChessCore::GameOverFlags::IS_GAME_OVER)
+		{
+			if (gameOverFlags & ChessCore::GameOverFlags::IS_CHECKMATE)
+				result = whiteToMove ? "0" : "1";
+			break;
+		}
+
+		const ChessCore::Move move = bot.GetNextMove(board, clock);
+		const int score = bot.GetLastScore().value_or(0);
+		const int whiteScore = whiteToMove ? score : -score;
+
+		// A found mate or a lasting large advantage ends the game, the rest of it wouldn't teach much
+		if (NeraChessBot::IsMateScore(score))
+		{
+			result = whiteScore > 0 ? "1" : "0";
+			break;
+		}
+
+		const int sign = std::abs(whiteScore) >= c_AdjudicationScore ? (whiteScore > 0 ? 1 : -1) : 0;
+		adjudicationCount = sign == 0 ? 0 : (sign == adjudicationSign ? adjudicationCount + 1 : 1);
+		adjudicationSign = sign;
+		if (adjudicationCount >= c_AdjudicationPlies)
+		{
+			result = sign > 0 ? "1" : "0";
+			break;
+		}
+
+		// Only quiet positions, the score of a position in check or in the middle of an exchange
+		// depends on the tactics the network can't see statically
+		const bool isQuietMove = !(move.GetMoveFlags() & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_EN_PASSANT | ChessCore::MoveFlags::IS_PROMOTION));
+		if (isQuietMove && !board.IsInCheck() && board.GetLegalMoves().size() > 1)
+			positions.emplace_back(board.GetFENString(), whiteScore);
+
+		board.MakeMove(move, true);
+	}
+
+	std::string lines;
+	for (const auto& [fen, whiteScore] : positions)
+		lines += fen + "," + std::to_string(whiteScore) + "," + result + "\n";
+	return lines;
+}
+
+static void RunWorker(uint32_t threadIndex, const GeneratorSettings& settings, SharedState& shared)
+{
+	std::mt19937_64 rng(settings.seed + threadIndex);
+
+	NeraChessBot bot(settings.modelPath, settings.hashMegabytes);
+	bot.SetEvalBackend(settings.modelPath.empty() ? EvalBackend::CLASSICAL : EvalBackend::NEURAL_NETWORK);
+	bot.SetNodeLimit(settings.nodes);
+	bot.SetUseOpeningBook(false);
+	bot.SetVerbose(false);
+
+	while (shared.positions.load(std::memory_order_relaxed) < settings.positionCount)
+	{
+		const std::string lines = PlayGame(bot, settings, rng);
+		if (lines.empty())
+			continue;
+
+		const uint64_t lineCount = std::count(lines.begin(), lines.end(), '\n');
+
+		std::lock_guard<std::mutex> lock(shared.outputMutex);
+		shared.output << lines;
+
+		const uint64_t before = shared.positions.fetch_add(lineCount, std::memory_order_relaxed);
+		const uint64_t games = shared.games.fetch_add(1, std::memory_order_relaxed) + 1;
+
+		if ((before + lineCount) / c_ProgressInterval != before / c_ProgressInterval)
+		{
+			const double hours = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count() / 3600.0;
+			std::cout << "Positions: " << before + lineCount << ", games: " << games
+				<< ", positions per hour: " << (uint64_t)((before + lineCount) / std::max(hours, 1e-9)) << std::endl;
+		}
+	}
+}
+
+static bool ParseArguments(int argc, char** argv, GeneratorSettings& settings)
+{
+	std::vector<std::string_view> positional;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--positions" && hasValue)
+			settings.positionCount = std::stoull(argv[++i]);
+		else if (argument == "--nodes" && hasValue)
+			settings.nodes = std::max<uint64_t>(std::stoull(argv[++i]), 1);
+		else if (argument == "--random-plies" && hasValue)
+			settings.randomPlies = std::stoul(argv[++i]);
+		else if (argument == "--threads" && hasValue)
+			settings.threadCount = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument == "--hash" && hasValue)
+			settings.hashMegabytes = std::max<size_t>(std::stoull(argv[++i]), 1);
+		else if (argument == "--model" && hasValue)
+			settings.modelPath = argv[++i];
+		else if (argument == "--seed" && hasValue)
+			settings.seed = std::stoull(argv[++i]);
+		else if (argument.substr(0, 2) == "--")
+			return false;
+		else
+			positional.push_back(argument);
+	}
+
+	if (positional.size() != 1)
+		return false;
+
+	settings.outputPath = positional[0];
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	GeneratorSettings settings;
+	if (!ParseArguments(argc, argv, settings))
+	{
+		std::cout << "Usage: DataGen <output.csv> [--positions n] [--nodes n] [--random-plies n] [--threads n] [--hash mb] [--model model.onnx] [--seed n]" << std::endl;
+		return 1;
+	}
+
+	SharedState shared;
+	shared.output.open(settings.outputPath, std::ios::app | std::ios::binary);
+	if (!shared.output.is_open())
+	{
+		std::cout << "Could not open " << settings.outputPath << std::endl;
+		return 1;
+	}
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < settings.threadCount; i++)
+		workers.emplace_back(RunWorker, i, std::cref(settings), std::ref(shared));
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+	std::cout << "Wrote " << shared.positions << " positions from " << shared.games << " games in " << seconds << "s ("
+		<< (uint64_t)(shared.positions * 3600 / std::max(seconds, 1e-9)) << " per hour)" << std::endl;
+
+	return 0;
+}
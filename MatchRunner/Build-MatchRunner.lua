@@ -0,0 +1,87 @@
+project "MatchRunner"
+  kind "ConsoleApp"
+  language "C++"
+  cppdialect "C++23"
+  targetdir ("../bin/%{cfg.buildcfg}/%{prj.name}")
+  objdir ("../bin/Intermediates/%{cfg.buildcfg}/%{prj.name}")
+  staticruntime "off"
+
+  -- The players live in NeraChessApp, their sources are compiled in here without the app and UI
+  files
+  {
+    "src/**.cpp",
+    "src/**.h",
+
+    "../NeraChessApp/src/ChessPlayers/ChessPlayer.h",
+    "../NeraChessApp/src/ChessPlayers/Bots/BotRandom.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/FirstNNBot.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/MyBotOld.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/NeraChessBot.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/SearchStats.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/TranspositionTable.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/TimeManager.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/NeuralNetwork.*",
+    "../NeraChessApp/src/ChessPlayers/Bots/ModelRegistry.*",
+  }
+
+  includedirs
+  {
+    "src",
+
+    "../ChessCore/src",
+
+    "../NeraChessApp/src",
+
+    "../NeraChessApp/vendor/onnxruntime-win-x64-gpu-1.23.2/include",
+  }
+
+  libdirs
+  {
+    "../NeraChessApp/vendor/onnxruntime-win-x64-gpu-1.23.2/lib",
+  }
+
+  links
+  {
+    "ChessCore",
+
+    "onnxruntime",
+    "onnxruntime_providers_cuda",
+    "onnxruntime_providers_shared",
+    "onnxruntime_providers_tensorrt",
+  }
+
+  postbuildcommands
+  {
+    '{COPY} "%{prj.location}/../NeraChessApp/vendor/onnxruntime-win-x64-gpu-1.23.2/lib/**.dll" "%{cfg.targetdir}"',
+  }
+
+  -- Platform
+
+  filter "system:windows"
+    systemversion "latest"
+    defines { "WINDOWS" }
+
+  filter "system:linux"
+    links { "pthread" }
+  filter {}
+
+  -- Configurations
+
+  filter "configurations:Debug"
+    defines { "DEBUG" }
+    runtime "Debug"
+    symbols "On"
+
+  filter "configurations:Release"
+    defines { "RELEASE" }
+    runtime "Release"
+    optimize "On"
+    symbols "On"
+
+  filter "configurations:Dist"
+    defines { "DIST" }
+    runtime "Release"
+    optimize "On"
+    symbols "Off"
+
+  filter {}
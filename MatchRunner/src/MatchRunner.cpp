@@ -0,0 +1,450 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ChessBoard.h"
+#include "Clock.h"
+#include "EPD.h"
+#include "PGN.h"
+
+#include "MatchStatistics.h"
+#include "PlayerSpec.h"
+
+// Plays engine against engine without the UI. Every thread owns one instance of both players and plays
+// colour swapped pairs: both games of a pair start from the same opening of the suite, once with each
+// player as white. Games are adjudicated from the players' scores, the match stops after the game count
+// or once the SPRT is decided, and every game is appended to the PGN
+
+struct MatchSettings
+{
+	std::array<PlayerSpec, 2> players;
+	std::string openingsPath;
+	std::string pgnPath = "Ressources/Games/MatchRunner.pgn";
+
+	uint32_t games = 100; // rounded up to whole pairs
+	uint32_t concurrency = 1;
+
+	ChessCore::Clock::Duration baseTime = std::chrono::seconds(10);
+	ChessCore::Clock::Duration increment = std::chrono::milliseconds(100);
+	std::string timeControl = "10+0.1";
+
+	// A side that is this far ahead in the eyes of both players for resignPlies plies in a row wins
+	int resignScore = 1000;
+	uint32_t resignPlies = 6;
+
+	// From drawMinPly on, drawPlies plies in a row within drawScore of 0 are a draw
+	int drawScore = 10;
+	uint32_t drawPlies = 16;
+	uint32_t drawMinPly = 80;
+
+	// Games still running at this ply are drawn, the PGN writer records game moves so any length fits
+	uint32_t maxPlies = 400;
+
+	bool useSPRT = false;
+	SPRTSettings sprt;
+};
+
+struct SharedState
+{
+	std::vector<std::string> openings;
+	uint32_t pairCount = 0;
+
+	std::atomic<uint32_t> nextPair = 0;
+	std::atomic<bool> stop = false;
+
+	std::mutex resultMutex;
+	MatchStatistics statistics;
+
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+};
+
+struct GameRecord
+{
+	double whitePoints = 0.5;
+	std::string termination;
+	std::string pgn;
+};
+
+// Tracks how long the scores have been decisive or drawish, the scores are from white's point of view
+class Adjudicator
+{
+public:
+	explicit Adjudicator(const MatchSettings& settings) : m_Settings(settings) {}
+
+	// Adds the score the mover reported for its move, returns true once the game is decided
+	bool Update(std::optional<int> whiteScore, uint32_t ply, double& whitePoints, std::string& termination)
+	{
+		if (!whiteScore)
+		{
+			m_ResignCount = 0;
+			m_DrawCount = 0;
+			return false;
+		}
+
+		const int score = *whiteScore;
+		const int sign = std::abs(score) >= m_Settings.resignScore ? (score > 0 ? 1 : -1) : 0;
+		m_ResignCount = sign == 0 ? 0 : (sign == m_ResignSign ? m_ResignCount + 1 : 1);
+		m_ResignSign = sign;
+
+		if (m_ResignCount >= m_Settings.resignPlies)
+		{
+			whitePoints = sign > 0 ? 1.0 : 0.0;
+			termination = "adjudication, resign";
+			return true;
+		}
+
+		m_DrawCount = ply >= m_Settings.drawMinPly && std::abs(score) <= m_Settings.drawScore ? m_DrawCount + 1 : 0;
+		if (m_DrawCount >= m_Settings.drawPlies)
+		{
+			whitePoints = 0.5;
+			termination = "adjudication, draw";
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	const MatchSettings& m_Settings;
+	uint32_t m_ResignCount = 0;
+	int m_ResignSign = 0;
+	uint32_t m_DrawCount = 0;
+};
+
+static std::string GetDate()
+{
+	const std::time_t now = std::time(nullptr);
+	std::tm date{};
+#ifdef _WIN32
+	localtime_s(&date, &now);
+#else
+	localtime_r(&now, &date);
+#endif
+
+	char text[16];
+	std::strftime(text, sizeof(text), "%Y.%m.%d", &date);
+	return text;
+}
+
+static GameRecord PlayGame(ChessPlayer& white, ChessPlayer& black, const std::string& whiteName, const std::string& blackName,
+	const std::string& opening, const std::string& round, const MatchSettings& settings)
+{
+	ChessCore::ChessBoard board(opening);
+
+	ChessCore::PGNWriter pgn(board);
+	pgn.SetTag("Event", "MatchRunner");
+	pgn.SetTag("Site", "NeraChess");
+	pgn.SetTag("Date", GetDate());
+	pgn.SetTag("Round", round);
+	pgn.SetTag("White", whiteName);
+	pgn.SetTag("Black", blackName);
+	pgn.SetTag("TimeControl", settings.timeControl);
+
+	white.ResetGame();
+	black.ResetGame();
+
+	ChessCore::Clock clock(settings.baseTime, settings.increment);
+	clock.Start(board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove));
+
+	Adjudicator adjudicator(settings);
+	GameRecord record;
+
+	for (uint32_t ply = 0;; ply++)
+	{
+		const bool whiteToMove = board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove);
+		ChessPlayer& mover = whiteToMove ? white : black;
+
+		const ChessCore::Move move = mover.GetNextMove(board, clock);
+
+		clock.Pause();
+
+		if (clock.IsFlagged(whiteToMove))
+		{
+			record.whitePoints = whiteToMove ? 0.0 : 1.0;
+			record.termination = "time forfeit";
+			break;
+		}
+
+		ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
+		if (std::find(legalMoves.begin(), legalMoves.end(), move) == legalMoves.end())
+		{
+			record.whitePoints = whiteToMove ? 0.0 : 1.0;
+			record.termination = "illegal move " + move.ToUCI();
+			break;
+		}
+
+		// Time after the move, with the increment Press() adds at the end of the turn
+		pgn.AddMove(move, clock.GetRemainingTime(whiteToMove) + clock.GetIncrement(whiteToMove));
+		board.MakeMove(move, true);
+
+		const uint16_t gameOverFlags = board.GetGameOver(true);
+		if (gameOverFlags & ChessCore::GameOverFlags::IS_GAME_OVER)
+		{
+			record.whitePoints = gameOverFlags & ChessCore::GameOverFlags::IS_CHECKMATE ? (whiteToMove ? 1.0 : 0.0) : 0.5;
+			record.termination = "normal";
+			break;
+		}
+
+		std::optional<int> whiteScore = mover.GetLastScore();
+		if (whiteScore && !whiteToMove)
+			whiteScore = -*whiteScore;
+
+		if (adjudicator.Update(whiteScore, ply, record.whitePoints, record.termination))
+			break;
+
+		if (ply + 1 >= settings.maxPlies)
+		{
+			record.whitePoints = 0.5;
+			record.termination = "adjudication, max plies";
+			break;
+		}
+
+		clock.Resume();
+		clock.Press();
+	}
+
+	clock.Stop();
+
+	pgn.SetResult(record.whitePoints > 0.75 ? "1-0" : record.whitePoints < 0.25 ? "0-1" : "1/2-1/2");
+	pgn.SetTag("Termination", record.termination);
+	record.pgn = pgn.ToString();
+	return record;
+}
+
+static void PrintStatus(const MatchSettings& settings, const SharedState& shared)
+{
+	const MatchStatistics& statistics = shared.statistics;
+	const EloEstimate elo = statistics.GetElo();
+
+	std::ostringstream status;
+	status.setf(std::ios::fixed);
+	status.precision(1);
+	status << "Games: " << statistics.GetGameCount() << "/" << shared.pairCount * 2
+		<< ", +" << statistics.GetWins() << " =" << statistics.GetDraws() << " -" << statistics.GetLosses()
+		<< ", score: " << statistics.GetScore() * 100.0 << "%"
+		<< ", elo: " << elo.elo << " +/- " << elo.error;
+
+	if (settings.useSPRT)
+	{
+		status.precision(2);
+		status << ", llr: " << statistics.GetLLR(settings.sprt)
+			<< " (" << settings.sprt.GetLowerBound() << ", " << settings.sprt.GetUpperBound() << ")";
+	}
+
+	std::cout << status.str() << std::endl;
+}
+
+static void RunWorker(const MatchSettings& settings, SharedState& shared)
+{
+	const std::unique_ptr<ChessPlayer> first = settings.players[0].Create();
+	const std::unique_ptr<ChessPlayer> second = settings.players[1].Create();
+
+	while (!shared.stop.load(std::memory_order_relaxed))
+	{
+		const uint32_t pairIndex = shared.nextPair.fetch_add(1, std::memory_order_relaxed);
+		if (pairIndex >= shared.pairCount)
+			break;
+
+		const std::string& opening = shared.openings[pairIndex % shared.openings.size()];
+		const std::string round = std::to_string(pairIndex + 1);
+
+		const GameRecord firstGame = PlayGame(*first, *second, settings.players[0].name, settings.players[1].name, opening, round + ".1", settings);
+		const GameRecord secondGame = PlayGame(*second, *first, settings.players[1].name, settings.players[0].name, opening, round + ".2", settings);
+
+		std::lock_guard<std::mutex> lock(shared.resultMutex);
+
+		shared.statistics.AddPair(firstGame.whitePoints, 1.0 - secondGame.whitePoints);
+
+		std::ofstream pgnFile(settings.pgnPath, std::ios::app | std::ios::binary);
+		pgnFile << firstGame.pgn << secondGame.pgn;
+
+		PrintStatus(settings, shared);
+
+		if (settings.useSPRT)
+		{
+			const double llr = shared.statistics.GetLLR(settings.sprt);
+			if (llr <= settings.sprt.GetLowerBound() || llr >= settings.sprt.GetUpperBound())
+				shared.stop.store(true, std::memory_order_relaxed);
+		}
+	}
+}
+
+static bool ParseTimeControl(std::string_view text, MatchSettings& settings)
+{
+	const size_t plus = text.find('+');
+	const std::string base(text.substr(0, plus));
+	const std::string increment = plus == std::string_view::npos ? "0" : std::string(text.substr(plus + 1));
+
+	char* end = nullptr;
+	const double baseSeconds = std::strtod(base.c_str(), &end);
+	if (end == base.c_str() || *end || baseSeconds <= 0.0)
+		return false;
+
+	const double incrementSeconds = std::strtod(increment.c_str(), &end);
+	if (end == increment.c_str() || *end || incrementSeconds < 0.0)
+		return false;
+
+	settings.baseTime = ChessCore::Clock::Duration((int64_t)std::llround(baseSeconds * 1000.0));
+	settings.increment = ChessCore::Clock::Duration((int64_t)std::llround(incrementSeconds * 1000.0));
+	settings.timeControl = text;
+	return true;
+}
+
+static bool ParseArguments(int argc, char** argv, MatchSettings& settings)
+{
+	std::vector<std::string_view> positional;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view argument = argv[i];
+		const bool hasValue = i + 1 < argc;
+
+		if (argument == "--openings" && hasValue)
+			settings.openingsPath = argv[++i];
+		else if (argument == "--pgn" && hasValue)
+			settings.pgnPath = argv[++i];
+		else if (argument == "--games" && hasValue)
+			settings.games = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument == "--concurrency" && hasValue)
+			settings.concurrency = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument == "--tc" && hasValue)
+		{
+			if (!ParseTimeControl(argv[++i], settings))
+				return false;
+		}
+		else if (argument == "--resign" && i + 2 < argc)
+		{
+			settings.resignScore = std::stoi(argv[++i]);
+			settings.resignPlies = std::stoul(argv[++i]);
+		}
+		else if (argument == "--draw" && i + 3 < argc)
+		{
+			settings.drawMinPly = std::stoul(argv[++i]);
+			settings.drawScore = std::stoi(argv[++i]);
+			settings.drawPlies = std::stoul(argv[++i]);
+		}
+		else if (argument == "--max-plies" && hasValue)
+			settings.maxPlies = std::max<uint32_t>(std::stoul(argv[++i]), 1);
+		else if (argument == "--sprt" && i + 4 < argc)
+		{
+			settings.useSPRT = true;
+			settings.sprt.elo0 = std::stod(argv[++i]);
+			settings.sprt.elo1 = std::stod(argv[++i]);
+			settings.sprt.alpha = std::stod(argv[++i]);
+			settings.sprt.beta = std::stod(argv[++i]);
+		}
+		else if (argument.substr(0, 2) == "--")
+			return false;
+		else
+			positional.push_back(argument);
+	}
+
+	if (positional.size() != 2)
+		return false;
+
+	return PlayerSpec::Parse(positional[0], settings.players[0]) && PlayerSpec::Parse(positional[1], settings.players[1]);
+}
+
+static bool LoadOpenings(const std::string& path, std::vector<std::string>& openings)
+{
+	std::ifstream input(path);
+	if (!input.is_open())
+	{
+		std::cout << "Could not open " << path << std::endl;
+		return false;
+	}
+
+	std::string line;
+	std::string fen;
+	while (std::getline(input, line))
+	{
+		if (!ChessCore::EPDToFEN(line, fen))
+			continue;
+
+		if (ChessCore::ChessBoard(fen).GetError() == 0)
+			openings.push_back(fen);
+	}
+
+	if (openings.empty())
+	{
+		std::cout << "No positions in " << path << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	MatchSettings settings;
+	if (!ParseArguments(argc, argv, settings))
+	{
+		std::cout << "Usage: MatchRunner <player1> <player2> [--openings suite.epd] [--pgn games.pgn] [--games n] [--concurrency n]"
+			" [--tc seconds+increment] [--resign cp plies] [--draw minPly cp plies] [--max-plies n] [--sprt elo0 elo1 alpha beta]\n"
+			"Players: nera[:eval=nn|classical,hash=mb,nodes=n,book=0|1,model=path,name=name], firstnn[:model=path], myold, random" << std::endl;
+		return 1;
+	}
+
+	SharedState shared;
+	if (settings.openingsPath.empty())
+		shared.openings.push_back(ChessCore::ChessBoard().GetFENString());
+	else if (!LoadOpenings(settings.openingsPath, shared.openings))
+		return 1;
+
+	shared.pairCount = (settings.games + 1) / 2;
+
+	std::error_code error;
+	const std::filesystem::path pgnDirectory = std::filesystem::path(settings.pgnPath).parent_path();
+	if (!pgnDirectory.empty())
+		std::filesystem::create_directories(pgnDirectory, error);
+
+	if (!std::ofstream(settings.pgnPath, std::ios::app | std::ios::binary).is_open())
+	{
+		std::cout << "Could not open " << settings.pgnPath << std::endl;
+		return 1;
+	}
+
+	std::cout << settings.players[0].name << " vs " << settings.players[1].name << ", " << shared.pairCount * 2 << " games, "
+		<< shared.openings.size() << " openings, tc " << settings.timeControl << ", concurrency " << settings.concurrency << std::endl;
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < std::min(settings.concurrency, shared.pairCount); i++)
+		workers.emplace_back(RunWorker, std::cref(settings), std::ref(shared));
+
+	for (std::thread& worker : workers)
+		worker.join();
+
+	const MatchStatistics& statistics = shared.statistics;
+	const std::array<uint64_t, 5>& pentanomial = statistics.GetPentanomial();
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - shared.startTime).count();
+
+	std::cout << "\nResult of " << settings.players[0].name << " vs " << settings.players[1].name << ":\n";
+	PrintStatus(settings, shared);
+	std::cout << "Pairs (0, 0.5, 1, 1.5, 2 points): " << pentanomial[0] << " " << pentanomial[1] << " " << pentanomial[2]
+		<< " " << pentanomial[3] << " " << pentanomial[4] << ", time: " << seconds << "s" << std::endl;
+
+	if (settings.useSPRT)
+	{
+		const double llr = statistics.GetLLR(settings.sprt);
+		std::cout << "SPRT [" << settings.sprt.elo0 << ", " << settings.sprt.elo1 << "]: "
+			<< (llr >= settings.sprt.GetUpperBound() ? "H1 accepted" : llr <= settings.sprt.GetLowerBound() ? "H0 accepted" : "inconclusive")
+			<< std::endl;
+	}
+
+	return 0;
+}
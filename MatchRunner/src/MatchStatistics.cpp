@@ -0,0 +1,96 @@
+#include "MatchStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr double c_MinPairVariance = 0.005;
+
+static double ScoreToElo(double score)
+{
+	score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+	return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double EloToScore(double elo)
+{
+	return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+double SPRTSettings::GetLowerBound() const
+{
+	return std::log(beta / (1.0 - alpha));
+}
+
+double SPRTSettings::GetUpperBound() const
+{
+	return std::log((1.0 - beta) / alpha);
+}
+
+void MatchStatistics::AddPair(double firstGame, double secondGame)
+{
+	for (double points : { firstGame, secondGame })
+	{
+		if (points > 0.75)
+			m_Wins++;
+		else if (points > 0.25)
+			m_Draws++;
+		else
+			m_Losses++;
+	}
+
+	const int halfPoints = (int)std::lround((firstGame + secondGame) * 2.0);
+	m_Pentanomial[std::clamp(halfPoints, 0, 4)]++;
+	m_PairCount++;
+}
+
+double MatchStatistics::GetScore() const
+{
+	const uint64_t games = GetGameCount();
+	return games ? (m_Wins + 0.5 * m_Draws) / games : 0.5;
+}
+
+void MatchStatistics::GetPairMoments(double& mean, double& variance) const
+{
+	mean = 0.0;
+	variance = 0.0;
+	if (m_PairCount == 0)
+		return;
+
+	for (size_t i = 0; i < m_Pentanomial.size(); i++)
+		mean += m_Pentanomial[i] * (i / 4.0);
+	mean /= m_PairCount;
+
+	for (size_t i = 0; i < m_Pentanomial.size(); i++)
+		variance += m_Pentanomial[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+	variance /= m_PairCount;
+}
+
+EloEstimate MatchStatistics::GetElo() const
+{
+	double mean, variance;
+	GetPairMoments(mean, variance);
+	if (m_PairCount == 0)
+		return {};
+
+	const double margin = 1.959964 * std::sqrt(variance / m_PairCount);
+
+	EloEstimate estimate;
+	estimate.elo = ScoreToElo(mean);
+	estimate.error = (ScoreToElo(mean + margin) - ScoreToElo(mean - margin)) / 2.0;
+	return estimate;
+}
+
+double MatchStatistics::GetLLR(const SPRTSettings& settings) const
+{
+	double mean, variance;
+	GetPairMoments(mean, variance);
+	if (m_PairCount < 2)
+		return 0.0;
+
+	// A one sided start (every pair won) has no variance at all, the floor lets such a match still end
+	variance = std::max(variance, c_MinPairVariance);
+
+	const double score0 = EloToScore(settings.elo0);
+	const double score1 = EloToScore(settings.elo1);
+	return m_PairCount * (score1 - score0) * (2.0 * mean - score0 - score1) / (2.0 * variance);
+}
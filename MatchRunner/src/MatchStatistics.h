@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// Sequential probability ratio test between two Elo hypotheses (logistic Elo)
+struct SPRTSettings
+{
+	double elo0 = 0.0;
+	double elo1 = 5.0;
+	double alpha = 0.05;
+	double beta = 0.05;
+
+	// The test accepts H0 below the lower bound and H1 above the upper one
+	double GetLowerBound() const;
+	double GetUpperBound() const;
+};
+
+struct EloEstimate
+{
+	double elo = 0.0;
+	double error = 0.0; // 95% confidence
+};
+
+// Match results from the first player's point of view. Games are counted in colour swapped pairs
+// (pentanomial: 0, 0.5, 1, 1.5 or 2 points per pair), which takes the opening's bias out of the variance
+class MatchStatistics
+{
+public:
+	// Points of the first player in both games of a pair, 0, 0.5 or 1 each
+	void AddPair(double firstGame, double secondGame);
+
+	uint64_t GetWins() const { return m_Wins; }
+	uint64_t GetDraws() const { return m_Draws; }
+	uint64_t GetLosses() const { return m_Losses; }
+	uint64_t GetGameCount() const { return m_Wins + m_Draws + m_Losses; }
+	uint64_t GetPairCount() const { return m_PairCount; }
+	const std::array<uint64_t, 5>& GetPentanomial() const { return m_Pentanomial; }
+
+	// Average points per game
+	double GetScore() const;
+	EloEstimate GetElo() const;
+
+	// Log likelihood ratio of elo1 against elo0 under the normal approximation of the pair scores
+	double GetLLR(const SPRTSettings& settings) const;
+
+private:
+	// Mean and variance of the per game score of a pair (pair points / 2)
+	void GetPairMoments(double& mean, double& variance) const;
+
+private:
+	uint64_t m_Wins = 0;
+	uint64_t m_Draws = 0;
+	uint64_t m_Losses = 0;
+
+	uint64_t m_PairCount = 0;
+	std::array<uint64_t, 5> m_Pentanomial{};
+};
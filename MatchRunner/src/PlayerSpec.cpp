@@ -0,0 +1,81 @@
+#include "PlayerSpec.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "ChessPlayers/Bots/BotRandom.h"
+#include "ChessPlayers/Bots/FirstNNBot.h"
+#include "ChessPlayers/Bots/MyBotOld.h"
+
+bool PlayerSpec::Parse(std::string_view text, PlayerSpec& spec)
+{
+	spec = PlayerSpec();
+	spec.name = text;
+
+	const size_t colon = text.find(':');
+	spec.type = text.substr(0, colon);
+
+	if (spec.type != "nera" && spec.type != "firstnn" && spec.type != "myold" && spec.type != "random")
+	{
+		std::cout << "Unknown player type " << spec.type << std::endl;
+		return false;
+	}
+
+	std::string_view options = colon == std::string_view::npos ? std::string_view() : text.substr(colon + 1);
+	while (!options.empty())
+	{
+		const size_t comma = options.find(',');
+		const std::string_view option = options.substr(0, comma);
+		options = comma == std::string_view::npos ? std::string_view() : options.substr(comma + 1);
+
+		const size_t equals = option.find('=');
+		const std::string_view key = option.substr(0, equals);
+		const std::string value = equals == std::string_view::npos ? std::string() : std::string(option.substr(equals + 1));
+
+		const bool isNera = spec.type == "nera";
+		const bool hasModel = isNera || spec.type == "firstnn";
+
+		if (key == "name" && !value.empty())
+			spec.name = value;
+		else if (key == "model" && hasModel && !value.empty())
+			spec.modelPath = value;
+		else if (key == "eval" && isNera && (value == "nn" || value == "classical"))
+			spec.evalBackend = value == "nn" ? EvalBackend::NEURAL_NETWORK : EvalBackend::CLASSICAL;
+		else if (key == "hash" && isNera && !value.empty())
+			spec.hashMegabytes = std::max<size_t>(std::stoull(value), 1);
+		else if (key == "nodes" && isNera && !value.empty())
+			spec.nodeLimit = std::stoull(value);
+		else if (key == "book" && isNera && (value == "0" || value == "1"))
+			spec.useOpeningBook = value == "1";
+		else
+		{
+			std::cout << "Unknown option " << option << " for player type " << spec.type << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+std::unique_ptr<ChessPlayer> PlayerSpec::Create() const
+{
+	if (type == "nera")
+	{
+		// The classical eval never asks the network, so none is loaded
+		const bool useNetwork = evalBackend == EvalBackend::NEURAL_NETWORK;
+		std::unique_ptr<NeraChessBot> bot = std::make_unique<NeraChessBot>(useNetwork ? modelPath : std::string(), hashMegabytes);
+		bot->SetEvalBackend(evalBackend);
+		bot->SetNodeLimit(nodeLimit);
+		bot->SetUseOpeningBook(useOpeningBook);
+		bot->SetVerbose(false);
+		return bot;
+	}
+
+	if (type == "firstnn")
+		return std::make_unique<FirstNNBot>(modelPath);
+
+	if (type == "myold")
+		return std::make_unique<MyBotOld>();
+
+	return std::make_unique<BotRandom>();
+}
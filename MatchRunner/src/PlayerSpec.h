@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ChessPlayers/ChessPlayer.h"
+#include "ChessPlayers/Bots/NeraChessBot.h"
+
+// One side of a match as given on the command line, "type[:option=value,...]":
+//   nera     options eval=nn|classical, hash=<mb>, nodes=<n>, book=0|1, model=<path>
+//   firstnn  option  model=<path>
+//   myold, random
+// Every type also takes name=<name> for the PGN, the spec itself is the default name
+struct PlayerSpec
+{
+	std::string name;
+	std::string type;
+
+	std::string modelPath = "Ressources/NeuralNetworks/model6b48.onnx";
+	EvalBackend evalBackend = EvalBackend::NEURAL_NETWORK;
+	size_t hashMegabytes = 64;
+	uint64_t nodeLimit = 0;
+	bool useOpeningBook = false; // the openings come from the suite
+
+	// False (with a message) for unknown types or options
+	static bool Parse(std::string_view text, PlayerSpec& spec);
+
+	// A new player, every game thread has its own
+	std::unique_ptr<ChessPlayer> Create() const;
+};
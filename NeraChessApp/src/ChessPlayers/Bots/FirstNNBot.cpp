@@ -12,29 +12,14 @@
 
 FirstNNBot::FirstNNBot(const std::string& modelPath)
 {
-	if (std::filesystem::exists(modelPath)) 
-		std::cout << "Model found\n";
-	else
-	{
-		std::cout << "Model missing (" + modelPath + ")\n";
+	m_Model = ModelRegistry::Acquire(modelPath);
+	if (!m_Model)
 		return;
-	}
-
-	// Initialization of OnnxRuntime
-	std::wstring wide(modelPath.begin(), modelPath.end());
-	const wchar_t* wmodelPath = wide.c_str();
-	m_Session = Ort::Session(m_Env, wmodelPath, m_SessionOptions);
 
 	m_InputVector.resize(1);
 
 }
 
-FirstNNBot::~FirstNNBot()
-{
-	m_Session.release();
-	m_Env.release();
-}
-
 ChessCore::Move FirstNNBot::GetNextMove(const ChessCore::ChessBoard& givenBoard, const ChessCore::Clock& timer)
 {
 	ChessCore::ChessBoard board = givenBoard;
@@ -197,7 +182,7 @@ float FirstNNBot::EvaluateBoard(const ChessCore::ChessBoard& board, bool whiteTo
 
 	Ort::RunOptions options;
 
-	std::vector<Ort::Value> outputVector = m_Session.Run(
+	std::vector<Ort::Value> outputVector = m_Model->GetSession().Run(
 		options,
 		&m_InputName,
 		m_InputVector.data(),
@@ -4,12 +4,13 @@
 #include "onnxruntime_cxx_api.h"
 
 #include "../ChessPlayer.h"
+#include "ModelRegistry.h"
 
 class FirstNNBot : public ChessPlayer
 {
 public:
 	FirstNNBot(const std::string& modelPath = "Ressources/NeuralNetworks/model6b48.onnx");
-	~FirstNNBot();
+	~FirstNNBot() = default;
 
 	virtual ChessCore::Move GetNextMove(const ChessCore::ChessBoard& givenBoard, const ChessCore::Clock& timer) override;
 	virtual void ResetGame() override {};
@@ -51,9 +52,7 @@ private:
 	};
 	
 	// AI Stuff
-	Ort::Env m_Env{ ORT_LOGGING_LEVEL_WARNING, "FirstNNBot" };
-	Ort::SessionOptions m_SessionOptions;
-	Ort::Session m_Session{nullptr};
+	std::shared_ptr<SharedModel> m_Model;
 
 	std::array<float, c_InputTensorSize> m_InputArray = {};
 	Ort::MemoryInfo m_MemoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
@@ -0,0 +1,95 @@
+#include "ModelRegistry.h"
+
+#include "MappedFile.h"
+
+#include "onnxruntime_session_options_config_keys.h"
+
+#include <print>
+
+std::shared_ptr<SharedModel> ModelRegistry::Acquire(const std::string& modelPath, const InferenceConfig& config)
+{
+	std::lock_guard<std::mutex> lock(s_Mutex);
+
+	auto modelIt = s_Models.find(modelPath);
+	if (modelIt != s_Models.end())
+	{
+		if (std::shared_ptr<SharedModel> model = modelIt->second.lock())
+			return model;
+	}
+
+	std::shared_ptr<SharedModel> model = Load(modelPath, config);
+	if (model)
+		s_Models[modelPath] = model;
+
+	return model;
+}
+
+std::shared_ptr<SharedModel> ModelRegistry::Load(const std::string& modelPath, const InferenceConfig& config)
+{
+	ChessCore::MappedFile modelFile(modelPath);
+	if (!modelFile.IsOpen())
+	{
+		std::println("Model missing ({})", modelPath);
+		return nullptr;
+	}
+
+	std::println("Model found");
+
+	Ort::Env& env = GetEnv(config);
+
+	Ort::SessionOptions sessionOptions;
+	sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+	if (config.InterOpThreads > 1)
+		sessionOptions.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+
+	if (config.UseGlobalThreadPool && s_EnvHasGlobalThreadPool)
+	{
+		sessionOptions.DisablePerSessionThreads();
+	}
+	else
+	{
+		if (config.UseGlobalThreadPool)
+			std::println("Global thread pool unavailable, the environment was created without one");
+
+		sessionOptions.SetIntraOpNumThreads(config.IntraOpThreads);
+		sessionOptions.SetInterOpNumThreads(config.InterOpThreads);
+
+		const char* spinning = config.AllowSpinning ? "1" : "0";
+		sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigAllowIntraOpSpinning, spinning);
+		sessionOptions.AddConfigEntry(kOrtSessionOptionsConfigAllowInterOpSpinning, spinning);
+	}
+
+	//OrtCUDAProviderOptions cudaOptions;
+	//cudaOptions.arena_extend_strategy = 0;
+	//cudaOptions.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchHeuristic;
+	//cudaOptions.do_copy_in_default_stream = 1;
+	//
+	//sessionOptions.AppendExecutionProvider_CUDA(cudaOptions);
+
+	// the session parses the graph out of the mapping, it is not needed after this
+	Ort::Session session(env, modelFile.Data(), modelFile.Size(), sessionOptions);
+
+	return std::make_shared<SharedModel>(modelPath, config, std::move(session));
+}
+
+Ort::Env& ModelRegistry::GetEnv(const InferenceConfig& config)
+{
+	// OnnxRuntime allows one environment per process, the first model loaded decides
+	// whether it comes with a global thread pool
+	static Ort::Env s_Env = [&config]()
+		{
+			if (!config.UseGlobalThreadPool)
+				return Ort::Env(ORT_LOGGING_LEVEL_WARNING, "NeraChessBot");
+
+			Ort::ThreadingOptions threadingOptions;
+			threadingOptions.SetGlobalIntraOpNumThreads(config.IntraOpThreads);
+			threadingOptions.SetGlobalInterOpNumThreads(config.InterOpThreads);
+			threadingOptions.SetGlobalSpinControl(config.AllowSpinning ? 1 : 0);
+
+			s_EnvHasGlobalThreadPool = true;
+			return Ort::Env(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "NeraChessBot");
+		}();
+
+	return s_Env;
+}
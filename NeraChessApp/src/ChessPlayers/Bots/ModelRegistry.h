@@ -0,0 +1,58 @@
+#pragma once
+
+#include "onnxruntime_cxx_api.h"
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+struct InferenceConfig
+{
+	int IntraOpThreads = 4; // threads a single Run may use, 0 lets OnnxRuntime decide
+	int InterOpThreads = 1; // > 1 runs independent graph nodes in parallel
+	bool UseGlobalThreadPool = false; // every session shares one pool instead of owning its own
+	bool AllowSpinning = false; // idle pool threads busy-wait instead of sleeping
+
+	uint16_t MaxBatchSize = 32;
+};
+
+// One loaded .onnx model. Ort::Session::Run may be called from any number of
+// threads at once, callers only need their own input / output buffers.
+class SharedModel
+{
+public:
+	SharedModel(const std::string& modelPath, const InferenceConfig& config, Ort::Session&& session)
+		: m_ModelPath(modelPath), m_Config(config), m_Session(std::move(session)) {}
+
+	Ort::Session& GetSession() { return m_Session; }
+
+	const std::string& GetModelPath() const { return m_ModelPath; }
+	const InferenceConfig& GetConfig() const { return m_Config; }
+
+private:
+	std::string m_ModelPath;
+	InferenceConfig m_Config;
+	Ort::Session m_Session;
+};
+
+// Process wide cache of loaded models, keyed by path. Every bot (and every
+// search thread) asking for the same model gets the same session, the model
+// is unloaded once the last user lets go of it. The session options come from
+// the config of whoever loaded the model first.
+class ModelRegistry
+{
+public:
+	static std::shared_ptr<SharedModel> Acquire(const std::string& modelPath, const InferenceConfig& config = {});
+
+private:
+	static std::shared_ptr<SharedModel> Load(const std::string& modelPath, const InferenceConfig& config);
+
+	static Ort::Env& GetEnv(const InferenceConfig& config);
+
+private:
+	static inline std::mutex s_Mutex;
+	static inline std::unordered_map<std::string, std::weak_ptr<SharedModel>> s_Models;
+
+	static inline bool s_EnvHasGlobalThreadPool = false;
+};
@@ -13,101 +13,76 @@
 #include <future>
 #include <fstream>
 
-constexpr float INF = 1e3;
+constexpr int INF = 32'000;
 
-NeraChessBot::NeraChessBot(const std::string& modelPath)
- : m_OpeningBook(c_OpeningBookPath), m_NeuralNetwork(modelPath)
+const std::array<std::array<uint8_t, 64>, 64> NeraChessBot::s_LateMoveReductions = []
 {
-	if (!m_OpeningBook)
-	{
+	std::array<std::array<uint8_t, 64>, 64> table{};
+	for (int depth = 1; depth < 64; depth++)
+		for (int moveIndex = 1; moveIndex < 64; moveIndex++)
+			table[depth][moveIndex] = (uint8_t)(c_LMRBase + std::log((float)depth) * std::log((float)moveIndex) / c_LMRDivisor);
+	return table;
+}();
+
+NeraChessBot::NeraChessBot(const std::string& modelPath, size_t hashMegabytes)
+ : m_OpeningBook(c_OpeningBookPath), m_TranspositionTable(hashMegabytes)
+{
+	if (!modelPath.empty())
+		m_NeuralNetwork = std::make_unique<NeuralNetwork>(modelPath);
+
+	if (!m_OpeningBook.IsOpen())
 		std::cout << "Opening book missing (" + c_OpeningBookPath + ")\n";
-		m_OpeningBookAvailable = false;
-	}
 }
 
 ChessCore::Move NeraChessBot::GetNextMove(const ChessCore::ChessBoard& givenBoard,const ChessCore::Clock& timer)
 {
-	m_SearchStartTime = std::chrono::steady_clock::now();
-	m_TimeUp = false;
+	m_TimeManager.StartSearch(timer, givenBoard.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove), givenBoard.GetFullMoveClock());
 
 	ChessCore::Move bestMove = 0;
 	
-	if (m_OpeningBookAvailable)
+	if (m_UseOpeningBook)
 	{
-		bestMove = GetOpeningBookMove(givenBoard);
+		bestMove = m_OpeningBook.GetWeightedMove(givenBoard, m_BookRng);
 		if (bestMove != 0)
 		{
-			std::cout << "Using opening book move: " + bestMove.ToUCI() + "\n";
+			if (m_Verbose)
+				std::cout << "Using opening book move: " + bestMove.ToUCI() + "\n";
 			return bestMove;
 		}
-		else
-		{
-			std::cout << "No opening book move found\n";
-			m_OpeningBookAvailable = false;
-		}
 	}
 
 	ChessCore::ChessBoard board = givenBoard;
 	bestMove = IterativeDeepeningSearch(board, 100);
-	
-	if (m_StopSearching)
-	{
-		m_StopSearching = false;
+
+	// The flag is set both by the time limit and by StopSearching, either way this search is over
+	m_StopSearching.store(false, std::memory_order_relaxed);
+
+	if (!bestMove)
 		return givenBoard.GetLegalMoves()[0];
-	}
 
 	return bestMove;
 }
 
-ChessCore::Move NeraChessBot::GetOpeningBookMove(const ChessCore::ChessBoard& board)
+void NeraChessBot::ResetGame()
 {
-	std::string fen = board.GetFENString();
-
-	std::string uciMove = "";
-
-	std::string line;
-	while (std::getline(m_OpeningBook, line))
-	{
-		if (m_StopSearching)
-			return 0;
-		size_t position = line.find(',');
-		if (position == std::string::npos) continue;
-
-		if (line.compare(0, position, fen) == 0) {
-			uciMove = line.substr(position + 1);
-			break;
-		}
-	}
-
-	m_OpeningBook.clear();
-	m_OpeningBook.seekg(0);
-
-	if (uciMove == "")
-		return 0;
-
-	ChessCore::Move bareMove(uciMove);
-
-	ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
-	for (ChessCore::Move move : legalMoves)
-	{
-		if (move.GetStartSquare() == bareMove.GetStartSquare() &&
-			move.GetTargetSquare() == bareMove.GetTargetSquare() &&
-			move.GetPromoPiece() == bareMove.GetPromoPiece())
-		{
-			return move;
-		}
-	}
-
-	return 0;
+	m_StopSearching.store(false, std::memory_order_relaxed);
+	ClearHistories();
 }
 
 ChessCore::Move NeraChessBot::IterativeDeepeningSearch(ChessCore::ChessBoard& board, uint32_t maxDepth)
 {
-	if (m_StopSearching)
+	if (IsStopped())
 		return 0;
 	m_NodesSearched = 0;
-	m_NodesEvaluated = 0;
-	m_QuiescenceNodesSearched = 0;
+	m_Stats.Reset();
+	m_CacheHitsAtSearchStart = m_NeuralNetwork ? m_NeuralNetwork->GetCacheHits() : 0;
+	PublishStats();
+	m_TimeCheckCountdown = c_TimeCheckInterval;
+	m_PreviousPVLength = 0;
+
+	AgeHistories();
+
+	m_LastScore = 0;
 
 	ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
 	if (legalMoves.size() == 1)
@@ -117,101 +92,227 @@ ChessCore::Move NeraChessBot::IterativeDeepeningSearch(ChessCore::ChessBoard& bo
 
 	uint8_t depthReached = 0;
 
+	int previousScore = 0;
+
+	uint64_t nodesBeforeIteration = 0;
+	int64_t millisecondsBeforeIteration = 0;
+
 	for (m_CurrentDepth = 1; m_CurrentDepth <= maxDepth; m_CurrentDepth++)
 	{
 		m_SearchID++;
-		ChessCore::Move move = PVSRoot(board, m_CurrentDepth);
 
-		if (m_TimeUp || m_StopSearching) break;
+		// Aspiration windows, mate scores and shallow depths are too unstable for a narrow window
+		int window = c_AspirationWindow;
+		int alpha = -INF;
+		int beta = INF;
+		if (m_CurrentDepth >= c_AspirationMinDepth && std::abs(previousScore) < c_MateBound)
+		{
+			alpha = previousScore - window;
+			beta = previousScore + window;
+		}
+
+		ChessCore::Move move = 0;
+		while (true)
+		{
+			m_FollowPV = true;
+			move = PVSRoot(board, m_CurrentDepth, alpha, beta);
+
+			if (IsStopped()) break;
+
+			if (m_RootScore <= alpha && alpha > -INF)
+			{
+				window *= 2;
+				alpha = std::max(m_RootScore - window, -INF);
+			}
+			else if (m_RootScore >= beta && beta < INF)
+			{
+				window *= 2;
+				beta = std::min(m_RootScore + window, INF);
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		if (IsStopped()) break;
+
+		previousScore = m_RootScore;
+
+		m_TimeManager.OnIterationComplete(move, m_RootScore);
+
+		m_PreviousPVLength = m_PVLength[0];
+		std::copy(m_PVTable[0], m_PVTable[0] + m_PVLength[0], m_PreviousPV);
 
 		bestMove = move;
 		depthReached = m_CurrentDepth;
+		m_LastScore = m_RootScore;
 
-		std::cout << "Thinking of move " <<
-			bestMove.GetStartSquare().ToString() <<
-			bestMove.GetTargetSquare().ToString() <<
-			" at depth " << (int)depthReached << "\n";
+		const int64_t milliseconds = m_TimeManager.Elapsed().count();
+		m_Stats.iterations.push_back({ depthReached, m_RootScore, m_NodesSearched - nodesBeforeIteration, milliseconds - millisecondsBeforeIteration });
+		nodesBeforeIteration = m_NodesSearched;
+		millisecondsBeforeIteration = milliseconds;
+		PublishStats();
 
-		std::cout << "Nodes At depth: ";
-		for (uint8_t d = 0; d <= depthReached; d++)
+		if (m_Verbose)
 		{
-			std::cout << (int)d << ": " << m_NodesAtDepth[d] << ", ";
-			m_NodesAtDepth[d] = 0;
+			std::cout << "Thinking of move " <<
+				bestMove.GetStartSquare().ToString() <<
+				bestMove.GetTargetSquare().ToString() <<
+				" at depth " << (int)depthReached << "\n";
+
+			if (std::abs(m_RootScore) >= c_MateBound)
+			{
+				const int matePlies = (int)(c_MateScore - std::abs(m_RootScore));
+				std::cout << (m_RootScore > 0 ? "Mate in " : "Mated in ") << (matePlies + 1) / 2 << "\n";
+			}
+
+			std::cout << "PV:";
+			for (uint8_t i = 0; i < m_PreviousPVLength; i++)
+				std::cout << " " << m_PreviousPV[i].ToUCI();
+			std::cout << "\n";
+
+			std::cout << "Nodes At depth: ";
+			for (uint8_t d = 0; d <= depthReached; d++)
+			{
+				std::cout << (int)d << ": " << m_NodesAtDepth[d] << ", ";
+				m_NodesAtDepth[d] = 0;
+			}
+			std::cout << "\n";
 		}
-		std::cout << "\n";
 
-		//std::cout << "Nodes searched: " << m_NodesSearched << "\n";
-		//std::cout << "Nodes evaluated: " << m_NodesEvaluated << "\n";
-		//std::cout << "Quiescence nodes searched: " << m_QuiescenceNodesSearched << "\n";
-		
+		if (m_TimeManager.ShouldStop())
+			break;
 	}
 
-	std::cout << "Nodes per second: " << (int)(m_NodesSearched / 15) << "\n";
+	PublishStats();
+
+	if (m_StatsLog.is_open())
+		m_StatsLog << m_Stats.ToJSON() << std::endl;
+
+	if (!m_Verbose)
+		return bestMove;
+
+	std::cout << "Searched for " << m_Stats.milliseconds << "ms (soft limit " << m_TimeManager.GetSoftLimit().count() << "ms, hard limit " << m_TimeManager.GetHardLimit().count() << "ms)\n";
+	std::cout << "Nodes per second: " << m_Stats.GetNodesPerSecond() << "\n";
 	std::cout << "Searched Depth " << (int)depthReached << " fully\n";
+	std::cout << m_Stats.ToInfoString() << "\n";
 
 	return bestMove;
 }
 
-ChessCore::Move NeraChessBot::PVSRoot(ChessCore::ChessBoard& board, int depth)
+std::optional<SearchStats> NeraChessBot::GetSearchStats() const
 {
-	if (m_StopSearching)
+	std::lock_guard<std::mutex> lock(m_PublishedStatsMutex);
+	return m_PublishedStats;
+}
+
+void NeraChessBot::SetStatsLogPath(const std::string& path)
+{
+	m_StatsLog.close();
+	if (path.empty())
+		return;
+
+	m_StatsLog.open(path, std::ios::app);
+	if (!m_StatsLog.is_open())
+		std::cout << "Could not open " << path << "\n";
+}
+
+void NeraChessBot::PublishStats()
+{
+	m_Stats.nodes = m_NodesSearched;
+	m_Stats.milliseconds = m_TimeManager.Elapsed().count();
+	m_Stats.networkCacheHits = m_NeuralNetwork ? m_NeuralNetwork->GetCacheHits() - m_CacheHitsAtSearchStart : 0;
+
+	std::lock_guard<std::mutex> lock(m_PublishedStatsMutex);
+	m_PublishedStats = m_Stats;
+}
+
+ChessCore::Move NeraChessBot::PVSRoot(ChessCore::ChessBoard& board, int depth, int alpha, int beta)
+{
+	if (IsStopped())
 		return 0;
 
+	// The root is always searched, an exact tt hit would cut the pv to a single move
 	TTEntry* ttProbePtr = m_TranspositionTable.Probe(board.GetZobristKey());
-	if (ttProbePtr && ttProbePtr->depth >= depth)
-	{
-		switch (ttProbePtr->flag)
-		{
-		case EntryFlag::EXACT:
-			return ttProbePtr->bestMove;
-		}
-	}
+
+	m_PVLength[0] = 0;
+	m_PlyStaticEval[0] = board.IsInCheck() ? INF : FastStaticEval(board);
 
 	ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
 
-	SortMoves(board, legalMoves, 0, ttProbePtr ? ttProbePtr->bestMove : ChessCore::Move(0));
+	const ChessCore::Move pvMove = GetPVMove(legalMoves, 0);
+	SortMoves(board, legalMoves, 0, ttProbePtr ? ttProbePtr->bestMove : ChessCore::Move(0), pvMove);
 
-	float bestScore = -INF;
+	int bestScore = -INF;
 	ChessCore::Move bestMove = legalMoves[0];
 
+	m_FollowPV = pvMove && bestMove == pvMove;
+	m_PlyMoves[0] = bestMove;
 	board.MakeMove(bestMove);
-	bestScore = -PrincipalVariationSearch(board, -INF, INF, depth - 1, 1);
+	bestScore = -PrincipalVariationSearch(board, -beta, -alpha, depth - 1, 1);
 	board.UndoMove(bestMove);
 
-	std::cout << "Assuming best move is: " << bestMove.ToUCI() << " with score " << (float)bestScore << "\n";
+	m_RootScore = bestScore;
+	UpdatePV(0, bestMove);
+
+	if (m_Verbose)
+		std::cout << "Assuming best move is: " << bestMove.ToUCI() << " with score " << bestScore << "\n";
+
+	if (bestScore >= beta)
+		return bestMove;
+
+	alpha = std::max(alpha, bestScore);
 
 	for (ChessCore::Move move : legalMoves)
 	{
 		if (move == legalMoves[0])
 			continue;
 
+		// Only a move that beats the current best in a null window gets the full window
+		m_FollowPV = false;
+		m_PlyMoves[0] = move;
 		board.MakeMove(move);
-		float score = -PrincipalVariationSearch(board, -INF, INF, depth - 1, 1);
+		int score = -PrincipalVariationSearch(board, -alpha - 1, -alpha, depth - 1, 1);
+		if (score > alpha && score < beta)
+		{
+			score = -PrincipalVariationSearch(board, -beta, -alpha, depth - 1, 1);
+		}
 		board.UndoMove(move);
 
+		if (IsTimeUp())
+		{
+			return bestMove;
+		}
+
 		if (score > bestScore)
 		{
 			bestScore = score;
 			bestMove = move;
+			m_RootScore = bestScore;
+			UpdatePV(0, bestMove);
 
-			std::cout << "New best move: " << bestMove.ToUCI() << " with score " << (float)bestScore << "\n";
+			if (m_Verbose)
+				std::cout << "New best move: " << bestMove.ToUCI() << " with score " << bestScore << "\n";
 		}
 
-		if (IsTimeUp())
-		{
+		if (bestScore >= beta)
 			return bestMove;
-		}
 
+		alpha = std::max(alpha, bestScore);
 	}
 
 	return bestMove;
 }
 
-float NeraChessBot::PrincipalVariationSearch(ChessCore::ChessBoard& board, float alpha, float beta, int depth, uint8_t ply)
+int NeraChessBot::PrincipalVariationSearch(ChessCore::ChessBoard& board, int alpha, int beta, int depth, uint8_t ply, bool allowNullMove, ChessCore::Move excludedMove)
 {
-	if (m_StopSearching)
+	if (IsStopped())
 		return 0;
 
+	if (ply < c_MaxPly)
+		m_PVLength[ply] = ply;
+
 	m_NodesSearched++;
 
 	if (IsTimeUp())
@@ -219,104 +320,228 @@ float NeraChessBot::PrincipalVariationSearch(ChessCore::ChessBoard& board, float
 		return alpha;
 	}
 
-	// TODO: Null Move Pruning
-
 	if (depth <= 0)
 		return QuiescenceSearch(board, alpha, beta, ply);
 
+	// Extensions could otherwise run past the per ply tables
+	if (ply >= c_MaxPly - 1)
+		return EvaluateBoard(board, alpha, beta);
+
 	m_NodesAtDepth[ply]++;
-	TTEntry* ttProbePtr = m_TranspositionTable.Probe(board.GetZobristKey());
-	if (ttProbePtr && ttProbePtr->depth >= depth)
+
+	// PV nodes don't take tt cutoffs so the pv reaches the full depth
+	const bool isPVNode = beta - alpha > 1;
+
+	// Mate distance pruning: nothing found from here can beat a mate that is already closer to the root
+	alpha = std::max(alpha, -c_MateScore + ply);
+	beta = std::min(beta, c_MateScore - ply - 1);
+	if (alpha >= beta)
+		return alpha;
+
+	// With a move excluded the stored result is for a different set of moves
+	// Copied, the null move search, its verification and the singular search can all overwrite the slot
+	const TTEntry* ttProbePtr = excludedMove ? nullptr : m_TranspositionTable.Probe(board.GetZobristKey());
+	const bool ttHit = ttProbePtr != nullptr;
+	const TTEntry ttEntry = ttHit ? *ttProbePtr : TTEntry();
+	SEARCH_STAT(m_Stats.ttProbes += !excludedMove);
+	SEARCH_STAT(m_Stats.ttHits += ttHit);
+	if (ttHit && ttEntry.depth >= depth && !isPVNode)
 	{
-		switch (ttProbePtr->flag)
+		const int ttValue = ScoreFromTT(ttEntry.value, ply);
+		switch (ttEntry.flag)
 		{
 		case EntryFlag::EXACT:
-			return ttProbePtr->value;
+			SEARCH_STAT(m_Stats.ttCutoffs++);
+			return ttValue;
 		case EntryFlag::LOWERBOUND:
-			if (ttProbePtr->value > alpha)
-				alpha = ttProbePtr->value;
+			if (ttValue > alpha)
+				alpha = ttValue;
 			break;
 		case EntryFlag::UPPERBOUND:
-			if (ttProbePtr->value < beta)
-				beta = ttProbePtr->value;
+			if (ttValue < beta)
+				beta = ttValue;
 			break;
 		}
 	}
 
-	float originAlpha = alpha;
+	int originAlpha = alpha;
 
 	if (alpha >= beta)
+	{
+		SEARCH_STAT(m_Stats.ttCutoffs++);
 		return beta;
+	}
+
+	if (ply < c_MaxPly)
+		m_PlyStaticEval[ply] = board.IsInCheck() ? INF : FastStaticEval(board);
+	const bool improving = IsImproving(ply);
+
+	// Null Move Pruning, not in pv nodes and not with only pawns left where zugzwang is common
+	if (allowNullMove && !isPVNode && !m_FollowPV && depth >= 3 && HasNonPawnMaterial(board) && FastStaticEval(board) >= beta)
+	{
+		const int reduction = NullMoveReduction(depth);
+
+		m_PlyMoves[ply] = 0;
+		if (board.MakeNullMove())
+		{
+			int nullScore = -PrincipalVariationSearch(board, -beta, -beta + 1, depth - 1 - reduction, ply + 1, false);
+			board.UndoNullMove();
+
+			if (IsStopped())
+				return alpha;
+
+			if (nullScore >= beta)
+			{
+				if (depth < c_NullMoveVerificationDepth ||
+					PrincipalVariationSearch(board, beta - 1, beta, depth - 1 - reduction, ply, false) >= beta)
+				{
+					SEARCH_STAT(m_Stats.nullMoveCutoffs++);
+					return beta;
+				}
+			}
+		}
+	}
 
 	ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
 	if (board.GetGameOver())
-		return EvaluateTerminal(board);
+		return EvaluateTerminal(board, ply);
+
+	if (excludedMove)
+	{
+		ChessCore::MoveList<218> remainingMoves;
+		for (ChessCore::Move move : legalMoves)
+		{
+			if (move != excludedMove)
+				remainingMoves.push(move);
+		}
+		legalMoves = remainingMoves;
 
-	SortMoves(board, legalMoves, ply, ttProbePtr ? ttProbePtr->bestMove : ChessCore::Move(0));
+		if (legalMoves.size() == 0)
+			return alpha;
+	}
+
+	const ChessCore::Move ttMove = ttHit ? ttEntry.bestMove : ChessCore::Move(0);
+
+	// Singular extension: the tt move is extended if no other move comes close to its score
+	ChessCore::Move singularMove = 0;
+	if (!excludedMove && ttMove && depth >= c_SingularMinDepth && ply < 2 * m_CurrentDepth &&
+		ttEntry.flag != EntryFlag::UPPERBOUND && ttEntry.depth >= depth - 3 && std::abs(ttEntry.value) < c_MateBound &&
+		std::find(legalMoves.begin(), legalMoves.end(), ttMove) != legalMoves.end())
+	{
+		const int singularBeta = ScoreFromTT(ttEntry.value, ply) - c_SingularMarginPerDepth * depth;
+		const bool followPV = m_FollowPV;
+		m_FollowPV = false;
 
-	float bestScore = -INF;
+		const int singularScore = PrincipalVariationSearch(board, singularBeta - 1, singularBeta, (depth - 1) / 2, ply, false, ttMove);
+
+		m_FollowPV = followPV;
+		if (ply < c_MaxPly)
+			m_PVLength[ply] = ply;
+
+		if (IsStopped())
+			return alpha;
+
+		if (singularScore < singularBeta)
+		{
+			singularMove = ttMove;
+			SEARCH_STAT(m_Stats.singularExtensions++);
+		}
+	}
+
+	const ChessCore::Move pvMove = GetPVMove(legalMoves, ply);
+	SortMoves(board, legalMoves, ply, ttMove, pvMove);
+
+	int bestScore = -INF;
 	ChessCore::Move bestMove = legalMoves[0];
 
+	// Moves searched without a cutoff, they lose history if a later move cuts
+	ChessCore::MoveList<218> quietsTried;
+	ChessCore::MoveList<218> capturesTried;
+
+	m_FollowPV = pvMove && bestMove == pvMove;
+	m_PlyMoves[ply] = bestMove;
 	board.MakeMove(bestMove);
-	bestScore = -PrincipalVariationSearch(board, -beta, -alpha, depth - 1, ply + 1);
+	bestScore = -PrincipalVariationSearch(board, -beta, -alpha, depth - 1 + MoveExtension(board, bestMove, singularMove, ply), ply + 1);
 	board.UndoMove(bestMove);
 
-	alpha = std::max(alpha, bestScore);
+	if (bestScore > alpha)
+	{
+		alpha = bestScore;
+		UpdatePV(ply, bestMove);
+	}
 
 	if (alpha >= beta)
 	{
-		m_TranspositionTable.Store(
-			board.GetZobristKey(),
-			beta,
-			depth,
-			EntryFlag::LOWERBOUND,
-			bestMove,
-			m_SearchID
-		);
+		SEARCH_STAT(m_Stats.betaCutoffs++);
+		SEARCH_STAT(m_Stats.firstMoveCutoffs++);
 
-		bool isQuiet = !(bestMove.GetMoveFlags() & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_PROMOTION)) && !board.IsInCheck();
-		if (isQuiet)
+		if (!excludedMove)
 		{
-			if (m_KillerMoves[ply][0] != bestMove && m_KillerMoves[ply][1] != bestMove)
-			{
-				m_KillerMoves[ply][1] = m_KillerMoves[ply][0];
-				m_KillerMoves[ply][0] = bestMove;
-			}
+			m_TranspositionTable.Store(
+				board.GetZobristKey(),
+				ScoreToTT(beta, ply),
+				depth,
+				EntryFlag::LOWERBOUND,
+				bestMove,
+				m_SearchID
+			);
 		}
-		m_HistoryHeuristic[bestMove.GetStartSquare()][bestMove.GetTargetSquare()] += ply * ply;
+
+		UpdateHistories(board, bestMove, ply, depth, quietsTried, capturesTried);
 
 		return beta;
 	}
 
+	if (IsQuietMove(bestMove))
+		quietsTried.push(bestMove);
+	else if (bestMove.GetMoveFlags() & ChessCore::MoveFlags::IS_CAPTURE)
+		capturesTried.push(bestMove);
+
 	for (size_t moveIndex = 1; moveIndex < legalMoves.size(); moveIndex++)
 	{
 		ChessCore::Move move = legalMoves[moveIndex];
 
+		m_FollowPV = false;
+		m_PlyMoves[ply] = move;
 		board.MakeMove(move);
 
 		bool isQuiet = !(move.GetMoveFlags() & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_PROMOTION)) && !board.IsInCheck();
 
-		uint8_t reduction = 0;
+		const int extension = MoveExtension(board, move, singularMove, ply);
+		int reduction = 0;
 
 		if (isQuiet)
 		{
 			// Futility Pruning
 
-			float futilityMargin = ply;
+			int futilityMargin = c_FutilityMarginPerPly * ply;
+
+			// pruned if the eval is above this, from the side that moves next
+			int futilityThreshold = futilityMargin - alpha;
 			
-			if (-EvaluateBoard(board) + futilityMargin < alpha)
+			if (-EvaluateBoard(board, futilityThreshold, futilityThreshold) + futilityMargin < alpha)
 			{
+				SEARCH_STAT(m_Stats.futilityPruned++);
 				board.UndoMove(move);
 				continue;
 			}
 
-			reduction = LateMoveReduction(depth, ply, (uint8_t)moveIndex);
+			const int history = GetQuietHistory(move, ply);
+			reduction = LateMoveReduction(depth, (uint8_t)moveIndex, history, isPVNode, improving);
 		}
 
-		float score = -PrincipalVariationSearch(board, -alpha - 1, -alpha, depth - 1 - reduction, ply + 1);
-		if (score > alpha) // && score < beta
+		// Reduced null window first, a move that beats alpha there is verified at full depth
+		// and only gets the full window if it is still inside it
+		int score = -PrincipalVariationSearch(board, -alpha - 1, -alpha, depth - 1 + extension - reduction, ply + 1);
+		SEARCH_STAT(m_Stats.reducedSearches += reduction > 0);
+		if (reduction > 0 && score > alpha)
+		{
+			SEARCH_STAT(m_Stats.reSearches++);
+			score = -PrincipalVariationSearch(board, -alpha - 1, -alpha, depth - 1 + extension, ply + 1);
+		}
+		if (score > alpha && score < beta)
 		{
-			score = -PrincipalVariationSearch(board, -beta, -alpha, depth - 1, ply + 1);
+			score = -PrincipalVariationSearch(board, -beta, -alpha, depth - 1 + extension, ply + 1);
 		}
 
 		board.UndoMove(move);
@@ -330,35 +555,39 @@ float NeraChessBot::PrincipalVariationSearch(ChessCore::ChessBoard& board, float
 		{
 			bestScore = score;
 			bestMove = move;
-			alpha = std::max(alpha, bestScore);
 		}
 
-		if (alpha >= beta)
+		if (score > alpha)
 		{
-			m_TranspositionTable.Store(
-				board.GetZobristKey(),
-				beta,
-				depth,
-				EntryFlag::LOWERBOUND,
-				bestMove,
-				m_SearchID
-			);
+			alpha = score;
+			UpdatePV(ply, move);
+		}
 
-			bool isQuiet = !(move.GetMoveFlags() & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_PROMOTION)) && !board.IsInCheck();
+		if (alpha >= beta)
+		{
+			SEARCH_STAT(m_Stats.betaCutoffs++);
 
-			if (isQuiet)
+			if (!excludedMove)
 			{
-				if (m_KillerMoves[ply][0] != bestMove && m_KillerMoves[ply][1] != bestMove)
-				{
-					m_KillerMoves[ply][1] = m_KillerMoves[ply][0];
-					m_KillerMoves[ply][0] = bestMove;
-				}
+				m_TranspositionTable.Store(
+					board.GetZobristKey(),
+					ScoreToTT(beta, ply),
+					depth,
+					EntryFlag::LOWERBOUND,
+					bestMove,
+					m_SearchID
+				);
 			}
-			m_HistoryHeuristic[bestMove.GetStartSquare()][bestMove.GetTargetSquare()] += ply * ply;
+
+			UpdateHistories(board, bestMove, ply, depth, quietsTried, capturesTried);
 
 			return beta;
 		}
 
+		if (IsQuietMove(move))
+			quietsTried.push(move);
+		else if (move.GetMoveFlags() & ChessCore::MoveFlags::IS_CAPTURE)
+			capturesTried.push(move);
 	}
 
 	EntryFlag flag;
@@ -367,40 +596,53 @@ float NeraChessBot::PrincipalVariationSearch(ChessCore::ChessBoard& board, float
 	else
 		flag = EntryFlag::EXACT;
 
-	m_TranspositionTable.Store(
-		board.GetZobristKey(),
-		bestScore,
-		depth,
-		flag,
-		bestMove,
-		m_SearchID);
+	if (!excludedMove)
+	{
+		m_TranspositionTable.Store(
+			board.GetZobristKey(),
+			ScoreToTT(bestScore, ply),
+			depth,
+			flag,
+			bestMove,
+			m_SearchID);
+	}
 
 	return bestScore;
 }
 
-float NeraChessBot::QuiescenceSearch(ChessCore::ChessBoard& board, float alpha, float beta, uint8_t ply)
+int NeraChessBot::QuiescenceSearch(ChessCore::ChessBoard& board, int alpha, int beta, uint8_t ply)
 {
-	if (m_StopSearching)
+	if (IsStopped())
 		return 0;
 
+	if (ply < c_MaxPly)
+		m_PVLength[ply] = ply;
+
 	m_NodesAtDepth[ply]++;
 	m_NodesSearched++;
-	m_QuiescenceNodesSearched++;
+	SEARCH_STAT(m_Stats.quiescenceNodes++);
+
+	if (ply >= c_MaxPly - 1)
+		return EvaluateBoard(board, alpha, beta);
 
 	TTEntry* ttEntryPtr = m_TranspositionTable.Probe(board.GetZobristKey());
+	SEARCH_STAT(m_Stats.ttProbes++);
+	SEARCH_STAT(m_Stats.ttHits += ttEntryPtr != nullptr);
 	if (ttEntryPtr)
 	{
+		const int ttValue = ScoreFromTT(ttEntryPtr->value, ply);
 		switch (ttEntryPtr->flag)
 		{
 		case EntryFlag::EXACT:
-			return ttEntryPtr->value;
+			SEARCH_STAT(m_Stats.ttCutoffs++);
+			return ttValue;
 		case EntryFlag::LOWERBOUND:
-			if (ttEntryPtr->value > alpha)
-				alpha = ttEntryPtr->value;
+			if (ttValue > alpha)
+				alpha = ttValue;
 			break;
 		case EntryFlag::UPPERBOUND:
-			if (ttEntryPtr->value < beta)
-				beta = ttEntryPtr->value;
+			if (ttValue < beta)
+				beta = ttValue;
 			break;
 		}
 	}
@@ -408,29 +650,52 @@ float NeraChessBot::QuiescenceSearch(ChessCore::ChessBoard& board, float alpha,
 	ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
 	ChessCore::MoveList<218> forcingMoves;
 
-	for (ChessCore::Move move : legalMoves)
+	// In check every evasion is searched and standing pat isn't an option
+	const bool inCheck = board.IsInCheck();
+	if (inCheck)
+	{
+		if (legalMoves.size() == 0)
+			return EvaluateTerminal(board, ply);
+
+		forcingMoves = legalMoves;
+	}
+	else
 	{
-		uint8_t flags = move.GetMoveFlags();
-		if (flags & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_PROMOTION))
+		for (ChessCore::Move move : legalMoves)
 		{
-			forcingMoves.push(move);
+			uint8_t flags = move.GetMoveFlags();
+			if (flags & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_PROMOTION))
+			{
+				// Captures that lose material in the exchange can't raise the stand pat score
+				if ((flags & ChessCore::MoveFlags::IS_CAPTURE) && StaticExchangeEval(board, move) < 0)
+				{
+					SEARCH_STAT(m_Stats.losingCapturesPruned++);
+					continue;
+				}
+
+				forcingMoves.push(move);
+			}
 		}
 	}
 
 	if (forcingMoves.size() == 0)
-		return EvaluateBoard(board);
+		return EvaluateBoard(board, alpha, beta);
 
 	if (forcingMoves.size() > 4)
 		SortMoves(board, forcingMoves, ply, ttEntryPtr ? ttEntryPtr->bestMove : ChessCore::Move(0));
 
-	alpha = std::max(EvaluateBoard(board), alpha);
+	if (!inCheck)
+	{
+		alpha = std::max(EvaluateBoard(board, alpha, beta), alpha);
 
-	if (alpha >= beta)
-		return alpha;
+		if (alpha >= beta)
+			return alpha;
+	}
 
-	float score = -INF;
+	int score = -INF;
 	for (ChessCore::Move move : forcingMoves)
 	{
+		m_PlyMoves[ply] = move;
 		board.MakeMove(move);
 		score = std::max(score, -QuiescenceSearch(board, -beta, -alpha, ply + 1));
 		board.UndoMove(move);
@@ -444,9 +709,15 @@ float NeraChessBot::QuiescenceSearch(ChessCore::ChessBoard& board, float alpha,
 	return alpha;
 }
 
-void NeraChessBot::SortMoves(const ChessCore::ChessBoard& board, ChessCore::MoveList<218>& moves, uint8_t ply, ChessCore::Move ttMove)
+void NeraChessBot::SortMoves(const ChessCore::ChessBoard& board, ChessCore::MoveList<218>& moves, uint8_t ply, ChessCore::Move ttMove, ChessCore::Move pvMove)
 {
-	static int moveValues[218];
+	// Not static, DataGen searches with one bot per thread
+	int moveValues[218];
+
+	// Quiet reply that refuted the move that led here
+	ChessCore::Move counterMove = 0;
+	if (ply > 0 && ply <= c_MaxPly && m_PlyMoves[ply - 1])
+		counterMove = m_CounterMoves[m_PlyMoves[ply - 1].GetMovePiece()][m_PlyMoves[ply - 1].GetTargetSquare()];
 
 	for (uint8_t i = 0; i < moves.size(); i++)
 	{
@@ -454,18 +725,33 @@ void NeraChessBot::SortMoves(const ChessCore::ChessBoard& board, ChessCore::Move
 
 		int score = 0;
 
-		// TT move first
+		// PV move first, then the TT move
+		if (pvMove && move == pvMove) {
+			moveValues[i] = 11'000'000;
+			continue;
+		}
+
 		if (move == ttMove) {
 			moveValues[i] = 10'000'000;
 			continue;
 		}
 
-		// MVV/LVA scoring
+		// Captures that hold up in the exchange go before the killers in MVV/LVA order, losing ones after the quiet moves
 		if (move.GetMoveFlags() & ChessCore::MoveFlags::IS_CAPTURE)
 		{
-			int attacker = (int)c_PieceValues[move.GetMovePiece()];
-			int victim = (int)c_PieceValues[board.GetPiece(move.GetTargetSquare())];
-			score += (victim - attacker) + 8'000'000;
+			const int see = StaticExchangeEval(board, move);
+			if (see >= 0)
+			{
+				const bool isEnPassant = move.GetMoveFlags() & ChessCore::MoveFlags::IS_EN_PASSANT;
+				int attacker = c_SEEPieceValues[move.GetMovePiece() % 6];
+				int victim = isEnPassant ? c_SEEPieceValues[0] : c_SEEPieceValues[board.GetPiece(move.GetTargetSquare()) % 6];
+				score += 10 * victim - attacker / 100 + 8'000'000 + GetCaptureHistory(board, move) / 16;
+			}
+			else
+			{
+				moveValues[i] = see - 1'000'000;
+				continue;
+			}
 		}
 		// Promotion bonus
 		if (move.GetMoveFlags() & ChessCore::MoveFlags::IS_PROMOTION)
@@ -473,11 +759,15 @@ void NeraChessBot::SortMoves(const ChessCore::ChessBoard& board, ChessCore::Move
 			score += 1000 + (int)c_PieceValues[move.GetPromoPiece()];
 		}
 
-		// Killer move bonus
-		if (move == m_KillerMoves[ply][0]) score += 7'000'000;
-		else if (move == m_KillerMoves[ply][1]) score += 6'000'000;
+		// Killers, the counter move, then history
+		if (IsQuietMove(move))
+		{
+			if (move == m_KillerMoves[ply][0]) score += 7'000'000;
+			else if (move == m_KillerMoves[ply][1]) score += 6'000'000;
+			else if (move == counterMove) score += 5'000'000;
 
-		score += m_HistoryHeuristic[move.GetStartSquare()][move.GetTargetSquare()];
+			score += GetQuietHistory(move, ply);
+		}
 
 		moveValues[i] = score;
 	}
@@ -497,57 +787,377 @@ void NeraChessBot::SortMoves(const ChessCore::ChessBoard& board, ChessCore::Move
 	}
 }
 
-float NeraChessBot::EvaluateBoard(const ChessCore::ChessBoard& board)
+int NeraChessBot::GetContinuationIndex(uint8_t ply, uint8_t pliesBack) const
 {
-	return m_NeuralNetwork.GetEvaluation(board) + 2 * FastStaticEval(board);
+	if (ply < pliesBack || ply - pliesBack >= c_MaxPly)
+		return -1;
+
+	const ChessCore::Move previous = m_PlyMoves[ply - pliesBack];
+	if (!previous)
+		return -1;
+
+	return previous.GetMovePiece() * 64 + previous.GetTargetSquare();
 }
 
-float NeraChessBot::FastStaticEval(const ChessCore::ChessBoard& board)
+int NeraChessBot::GetQuietHistory(ChessCore::Move move, uint8_t ply) const
 {
-	// Cheap material only + small piece-square bonus if you have it; otherwise return material difference.
-	float score = 0;
-	for (ChessCore::Square s = 0; s < 64; s++)
+	const uint8_t piece = move.GetMovePiece();
+	const uint8_t to = move.GetTargetSquare();
+
+	int history = m_ButterflyHistory[piece / 6][move.GetStartSquare()][to];
+	for (uint8_t pliesBack = 1; pliesBack <= 2; pliesBack++)
 	{
-		ChessCore::Piece p = board.GetPiece(s);
-		if (p != ChessCore::PieceType::NO_PIECE)
+		const int index = GetContinuationIndex(ply, pliesBack);
+		if (index >= 0)
+			history += m_ContinuationHistory[index][piece][to];
+	}
+	return history;
+}
+
+void NeraChessBot::UpdateQuietHistory(ChessCore::Move move, uint8_t ply, int bonus)
+{
+	const uint8_t piece = move.GetMovePiece();
+	const uint8_t to = move.GetTargetSquare();
+
+	UpdateHistoryEntry(m_ButterflyHistory[piece / 6][move.GetStartSquare()][to], bonus);
+	for (uint8_t pliesBack = 1; pliesBack <= 2; pliesBack++)
+	{
+		const int index = GetContinuationIndex(ply, pliesBack);
+		if (index >= 0)
+			UpdateHistoryEntry(m_ContinuationHistory[index][piece][to], bonus);
+	}
+}
+
+int16_t& NeraChessBot::GetCaptureHistory(const ChessCore::ChessBoard& board, ChessCore::Move move)
+{
+	const bool isEnPassant = move.GetMoveFlags() & ChessCore::MoveFlags::IS_EN_PASSANT;
+	const uint8_t captured = isEnPassant ? 0 : board.GetPiece(move.GetTargetSquare()) % 6;
+	return m_CaptureHistory[move.GetMovePiece()][move.GetTargetSquare()][captured];
+}
+
+void NeraChessBot::UpdateHistories(const ChessCore::ChessBoard& board, ChessCore::Move bestMove, uint8_t ply, int depth,
+	const ChessCore::MoveList<218>& quietsTried, const ChessCore::MoveList<218>& capturesTried)
+{
+	// The cutoff move is rewarded, the moves searched before it without a cutoff are penalised by the same amount
+	const int bonus = HistoryBonus(depth);
+
+	if (IsQuietMove(bestMove))
+	{
+		if (m_KillerMoves[ply][0] != bestMove)
 		{
-			score += c_PieceValues[p];
+			m_KillerMoves[ply][1] = m_KillerMoves[ply][0];
+			m_KillerMoves[ply][0] = bestMove;
 		}
+
+		const int previous = GetContinuationIndex(ply, 1);
+		if (previous >= 0)
+			m_CounterMoves[previous / 64][previous % 64] = bestMove;
+
+		UpdateQuietHistory(bestMove, ply, bonus);
+		for (ChessCore::Move quiet : quietsTried)
+			UpdateQuietHistory(quiet, ply, -bonus);
+	}
+	else if (bestMove.GetMoveFlags() & ChessCore::MoveFlags::IS_CAPTURE)
+	{
+		UpdateHistoryEntry(GetCaptureHistory(board, bestMove), bonus);
+	}
+
+	for (ChessCore::Move capture : capturesTried)
+		UpdateHistoryEntry(GetCaptureHistory(board, capture), -bonus);
+}
+
+void NeraChessBot::AgeHistories()
+{
+	// Earlier searches stay a hint, this search's cutoffs quickly outweigh them
+	for (auto& side : m_ButterflyHistory)
+		for (auto& from : side)
+			for (int16_t& entry : from)
+				entry /= 2;
+
+	for (PieceToHistory& table : m_ContinuationHistory)
+		for (auto& piece : table)
+			for (int16_t& entry : piece)
+				entry /= 2;
+
+	for (auto& piece : m_CaptureHistory)
+		for (auto& to : piece)
+			for (int16_t& entry : to)
+				entry /= 2;
+}
+
+void NeraChessBot::ClearHistories()
+{
+	std::fill(&m_KillerMoves[0][0], &m_KillerMoves[0][0] + sizeof(m_KillerMoves) / sizeof(ChessCore::Move), ChessCore::Move(0));
+	std::fill(&m_CounterMoves[0][0], &m_CounterMoves[0][0] + sizeof(m_CounterMoves) / sizeof(ChessCore::Move), ChessCore::Move(0));
+	std::fill(&m_ButterflyHistory[0][0][0], &m_ButterflyHistory[0][0][0] + sizeof(m_ButterflyHistory) / sizeof(int16_t), int16_t(0));
+	std::fill(&m_CaptureHistory[0][0][0], &m_CaptureHistory[0][0][0] + sizeof(m_CaptureHistory) / sizeof(int16_t), int16_t(0));
+	std::fill(m_ContinuationHistory.begin(), m_ContinuationHistory.end(), PieceToHistory{});
+}
+
+void NeraChessBot::UpdatePV(uint8_t ply, ChessCore::Move move)
+{
+	if (ply >= c_MaxPly)
+		return;
+
+	m_PVTable[ply][ply] = move;
+
+	const uint8_t childLength = ply + 1 < c_MaxPly ? m_PVLength[ply + 1] : ply + 1;
+	for (uint8_t i = ply + 1; i < childLength; i++)
+		m_PVTable[ply][i] = m_PVTable[ply + 1][i];
+
+	m_PVLength[ply] = std::max<uint8_t>(childLength, ply + 1);
+}
+
+ChessCore::Move NeraChessBot::GetPVMove(const ChessCore::MoveList<218>& moves, uint8_t ply)
+{
+	if (!m_FollowPV || ply >= m_PreviousPVLength)
+	{
+		m_FollowPV = false;
+		return 0;
+	}
+
+	for (ChessCore::Move move : moves)
+	{
+		if (move == m_PreviousPV[ply])
+			return move;
+	}
+
+	m_FollowPV = false;
+	return 0;
+}
+
+int NeraChessBot::EvaluateBoard(const ChessCore::ChessBoard& board, int alpha, int beta)
+{
+	const int staticEval = FastStaticEval(board);
+
+	if (m_EvalBackend == EvalBackend::CLASSICAL || !m_NeuralNetwork)
+		return staticEval;
+
+	// Lazy eval: the network can only move the score by about m_LazyEvalMargin,
+	// if that can't bring it back into the window its bound is good enough
+	if (staticEval + m_LazyEvalMargin <= alpha)
+	{
+		SEARCH_STAT(m_Stats.networkEvaluationsSkipped++);
+		return staticEval + m_LazyEvalMargin;
 	}
-	return score * float(board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove) ? 1.f : -1.f);
+	if (staticEval - m_LazyEvalMargin >= beta)
+	{
+		SEARCH_STAT(m_Stats.networkEvaluationsSkipped++);
+		return staticEval - m_LazyEvalMargin;
+	}
+
+	SEARCH_STAT(m_Stats.networkEvaluations++);
+
+	// The network predicts in pawns, the search works in centipawns. Kept clear of the mate scores
+	const int networkEval = (int)std::lround(m_NeuralNetwork->GetEvaluation(board) * c_NetworkScale);
+	return std::clamp(networkEval + staticEval, -c_MateBound + 1, c_MateBound - 1);
 }
 
-bool NeraChessBot::PositiveSEE(const ChessCore::ChessBoard& board, ChessCore::Move move)
+int NeraChessBot::FastStaticEval(const ChessCore::ChessBoard& board)
 {
-	float attacker = c_PieceValues[move.GetMovePiece()];
-	float victim = c_PieceValues[board.GetPiece(move.GetTargetSquare())];
-	return (victim - attacker) >= 0;
+	// Material + piece square tables in centipawns, kept up to date by the board on every move
+	const int score = board.GetStaticEval().GetTapered();
+	return board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove) ? score : -score;
 }
 
-float NeraChessBot::EvaluateTerminal(const ChessCore::ChessBoard& board)
+bool NeraChessBot::HasNonPawnMaterial(const ChessCore::ChessBoard& board) const
+{
+	const auto& bitboards = board.GetBoardState().pieceBitboards;
+
+	if (board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove))
+	{
+		return bitboards[ChessCore::PieceType::WHITE_KNIGHT] | bitboards[ChessCore::PieceType::WHITE_BISHOP] |
+			bitboards[ChessCore::PieceType::WHITE_ROOK] | bitboards[ChessCore::PieceType::WHITE_QUEEN];
+	}
+
+	return bitboards[ChessCore::PieceType::BLACK_KNIGHT] | bitboards[ChessCore::PieceType::BLACK_BISHOP] |
+		bitboards[ChessCore::PieceType::BLACK_ROOK] | bitboards[ChessCore::PieceType::BLACK_QUEEN];
+}
+
+int NeraChessBot::StaticExchangeEval(const ChessCore::ChessBoard& board, ChessCore::Move move) const
+{
+	// Swap list: both sides keep recapturing on the target square with their least valuable attacker,
+	// gain[d] is the material balance if the exchange stopped after capture d
+	const ChessCore::BoardState& state = board.GetBoardState();
+	const auto& bitboards = state.pieceBitboards;
+
+	const ChessCore::Square from = move.GetStartSquare();
+	const ChessCore::Square to = move.GetTargetSquare();
+	const uint8_t flags = move.GetMoveFlags();
+
+	ChessCore::Bitboard occupied = 0;
+	for (ChessCore::Bitboard bitboard : bitboards)
+		occupied |= bitboard;
+
+	int gain[32];
+	int depth = 0;
+
+	gain[0] = 0;
+	if (flags & ChessCore::MoveFlags::IS_EN_PASSANT)
+	{
+		gain[0] = c_SEEPieceValues[0];
+		// the captured pawn stands behind the target square, from the mover's point of view
+		occupied ^= 1ULL << (to.GetFile() + from.GetRank() * 8);
+	}
+	else if (flags & ChessCore::MoveFlags::IS_CAPTURE)
+	{
+		gain[0] = c_SEEPieceValues[board.GetPiece(to) % 6];
+	}
+
+	// Value of the piece standing on the target square, the next one to be captured
+	int pieceOnSquare = c_SEEPieceValues[move.GetMovePiece() % 6];
+	if (flags & ChessCore::MoveFlags::IS_PROMOTION)
+	{
+		pieceOnSquare = c_SEEPieceValues[move.GetPromoPiece() % 6];
+		gain[0] += pieceOnSquare - c_SEEPieceValues[0];
+	}
+
+	const ChessCore::Bitboard diagonalSliders = bitboards[ChessCore::PieceType::WHITE_BISHOP] | bitboards[ChessCore::PieceType::BLACK_BISHOP] |
+		bitboards[ChessCore::PieceType::WHITE_QUEEN] | bitboards[ChessCore::PieceType::BLACK_QUEEN];
+	const ChessCore::Bitboard orthogonalSliders = bitboards[ChessCore::PieceType::WHITE_ROOK] | bitboards[ChessCore::PieceType::BLACK_ROOK] |
+		bitboards[ChessCore::PieceType::WHITE_QUEEN] | bitboards[ChessCore::PieceType::BLACK_QUEEN];
+
+	occupied ^= 1ULL << from;
+	ChessCore::Bitboard attackers = ChessCore::MoveGenerator::AttackersTo(state, to, occupied) & occupied;
+
+	// the first recapture is by the side not making the move
+	bool whiteToCapture = !state.HasFlag(ChessCore::BoardStateFlags::WhiteToMove);
+
+	while (depth < 31)
+	{
+		// Least valuable attacker of the side to capture
+		const uint8_t firstPiece = whiteToCapture ? ChessCore::PieceType::WHITE_PAWN : ChessCore::PieceType::BLACK_PAWN;
+		ChessCore::Bitboard attacker = 0;
+		uint8_t attackerType = 0;
+		for (uint8_t type = 0; type < 6; type++)
+		{
+			attacker = attackers & bitboards[firstPiece + type];
+			if (attacker)
+			{
+				attackerType = type;
+				break;
+			}
+		}
+		if (!attacker)
+			break;
+
+		depth++;
+		gain[depth] = pieceOnSquare - gain[depth - 1];
+
+		pieceOnSquare = c_SEEPieceValues[attackerType];
+		occupied ^= attacker & (~attacker + 1);
+
+		// Sliders behind the piece that just captured join in
+		attackers |= ChessCore::MoveGenerator::GetSlidingAttacks(to, occupied, false) & diagonalSliders;
+		attackers |= ChessCore::MoveGenerator::GetSlidingAttacks(to, occupied, true) & orthogonalSliders;
+		attackers &= occupied;
+
+		whiteToCapture = !whiteToCapture;
+	}
+
+	// Each side only recaptures if that beats stopping the exchange before it
+	while (depth > 0)
+	{
+		gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+		depth--;
+	}
+
+	return gain[0];
+}
+
+int NeraChessBot::EvaluateTerminal(const ChessCore::ChessBoard& board, uint8_t ply)
 {
 	uint16_t overFlags = board.GetGameOver();
 
+	// Shorter mates score higher
 	if (overFlags & ChessCore::GameOverFlags::IS_CHECKMATE)
-		return -INF + board.GetFullMoveClock();
+		return -c_MateScore + ply;
 	else
 		return 0;
 }
 
-int NeraChessBot::LateMoveReduction(int depth, uint8_t ply, uint8_t moveIndex) const
+int16_t NeraChessBot::ScoreToTT(int score, uint8_t ply)
+{
+	if (score >= c_MateBound)
+		return (int16_t)(score + ply);
+	if (score <= -c_MateBound)
+		return (int16_t)(score - ply);
+	return (int16_t)score;
+}
+
+int NeraChessBot::ScoreFromTT(int score, uint8_t ply)
+{
+	if (score >= c_MateBound)
+		return score - ply;
+	if (score <= -c_MateBound)
+		return score + ply;
+	return score;
+}
+
+int NeraChessBot::LateMoveReduction(int depth, uint8_t moveIndex, int history, bool isPVNode, bool improving) const
+{
+	if (depth < c_LMRMinDepth || moveIndex < c_LMRMinMoveIndex)
+		return 0;
+
+	int reduction = s_LateMoveReductions[std::min(depth, 63)][std::min<int>(moveIndex, 63)];
+
+	if (isPVNode)
+		reduction--;
+	if (!improving)
+		reduction++;
+	reduction -= history / c_LMRHistoryDivisor;
+
+	// Late moves at the frontier may drop straight into the quiescence search
+	return std::clamp(reduction, 0, depth - 1);
+}
+
+int NeraChessBot::MoveExtension(const ChessCore::ChessBoard& board, ChessCore::Move move, ChessCore::Move singularMove, uint8_t ply) const
 {
-	if (ply < 4 || moveIndex < 3)
+	// Called after the move is made. Extensions stop at twice the iteration depth so checks can't extend forever
+	if (ply >= 2 * m_CurrentDepth)
 		return 0;
-	return 1 + moveIndex / 4;
+
+	if (board.IsInCheck() || move == singularMove)
+		return 1;
+
+	return 0;
+}
+
+bool NeraChessBot::IsImproving(uint8_t ply) const
+{
+	// Better static eval than two plies ago, the last time this side was to move
+	if (ply < 2 || ply >= c_MaxPly)
+		return false;
+	if (m_PlyStaticEval[ply] == INF || m_PlyStaticEval[ply - 2] == INF)
+		return false;
+	return m_PlyStaticEval[ply] > m_PlyStaticEval[ply - 2];
 }
 
 bool NeraChessBot::IsTimeUp()
 {
+	if (IsStopped())
+		return true;
+
 	if (m_CurrentDepth <= 1)
 		return false;
 
-	if (m_TimeUp)
+	if (m_NodeLimit && m_NodesSearched >= m_NodeLimit)
+	{
+		m_StopSearching.store(true, std::memory_order_relaxed);
+		return true;
+	}
+
+	// Reading the clock costs more than searching a node, only look every c_TimeCheckInterval calls
+	if (--m_TimeCheckCountdown > 0)
+		return false;
+
+	m_TimeCheckCountdown = c_TimeCheckInterval;
+
+	if (m_TimeManager.HardLimitReached())
+	{
+		m_StopSearching.store(true, std::memory_order_relaxed);
 		return true;
-	m_TimeUp = (std::chrono::steady_clock::now() - m_SearchStartTime) >= m_TimeLimitS;
-	return m_TimeUp;
+	}
+
+	return false;
 }
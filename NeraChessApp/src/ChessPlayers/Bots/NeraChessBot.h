@@ -4,46 +4,144 @@
 #include <chrono>
 #include <unordered_map>
 #include <fstream>
+#include <random>
 
 #include "../ChessPlayer.h"
+#include "OpeningBook.h"
 #include "TranspositionTable.h"
 #include "NeuralNetwork.h"
+#include "TimeManager.h"
+#include "SearchStats.h"
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
+#include <mutex>
 #include <array>
+#include <cstdlib>
+#include <vector>
+
+enum class EvalBackend : uint8_t
+{
+	NEURAL_NETWORK, // network on top of the static eval, lazily skipped outside the window
+	CLASSICAL,		// incrementally updated material + piece square tables only
+};
 
 class NeraChessBot : public ChessPlayer
 {
 public:
-	NeraChessBot(const std::string& modelPath = "Ressources/NeuralNetworks/model6b48.onnx");
+	// An empty model path loads no network, the bot then always uses the classical eval
+	NeraChessBot(const std::string& modelPath = "Ressources/NeuralNetworks/model6b48.onnx", size_t hashMegabytes = 256);
 
 	virtual ChessCore::Move GetNextMove(const ChessCore::ChessBoard& givenBoard, const ChessCore::Clock& timer) override;
-	virtual void ResetGame() override { m_OpeningBookAvailable = true; m_StopSearching = false; };
-	virtual void StopSearching() override { m_StopSearching = true; };
+	virtual void ResetGame() override;
+	virtual void StopSearching() override { m_StopSearching.store(true, std::memory_order_relaxed); };
+
+	// How far (in centipawns) the network may move the eval away from the static eval,
+	// positions further outside the window than this skip the network
+	void SetLazyEvalMargin(int margin) { m_LazyEvalMargin = margin; }
+
+	void SetEvalBackend(EvalBackend backend) { m_EvalBackend = backend; }
+
+	// Ends every search after this many nodes (0 for no limit), the clock still applies
+	void SetNodeLimit(uint64_t nodes) { m_NodeLimit = nodes; }
+
+	void SetUseOpeningBook(bool useBook) { m_UseOpeningBook = useBook; }
+
+	// Search progress and statistics on stdout
+	void SetVerbose(bool verbose) { m_Verbose = verbose; }
+
+	// Score of the last completed iteration in centipawns, from the side to move's point of view
+	virtual std::optional<int> GetLastScore() const override { return m_LastScore; }
+	static bool IsMateScore(int score) { return std::abs(score) >= c_MateBound; }
+
+	// Copy of the running search's statistics, updated after every iteration so another thread can show them live
+	virtual std::optional<SearchStats> GetSearchStats() const override;
+
+	// Appends every search's statistics to this file as one JSON line, an empty path stops the log
+	void SetStatsLogPath(const std::string& path);
 
 private:
-	
-	ChessCore::Move GetOpeningBookMove(const ChessCore::ChessBoard& board);
 
 	ChessCore::Move IterativeDeepeningSearch(ChessCore::ChessBoard& board, uint32_t maxDepth);
-	ChessCore::Move PVSRoot(ChessCore::ChessBoard& board, int depth);
+	ChessCore::Move PVSRoot(ChessCore::ChessBoard& board, int depth, int alpha, int beta);
+
+	int PrincipalVariationSearch(ChessCore::ChessBoard& board, int alpha, int beta, int depth, uint8_t ply, bool allowNullMove = true, ChessCore::Move excludedMove = 0);
+	int QuiescenceSearch(ChessCore::ChessBoard& board, int alpha, int beta, uint8_t ply);
+
+	int EvaluateBoard(const ChessCore::ChessBoard& board, int alpha, int beta);
+	int FastStaticEval(const ChessCore::ChessBoard& board);
+	int EvaluateTerminal(const ChessCore::ChessBoard& board, uint8_t ply);
+
+	int StaticExchangeEval(const ChessCore::ChessBoard& board, ChessCore::Move move) const;
+	bool HasNonPawnMaterial(const ChessCore::ChessBoard& board) const;
+
+	void SortMoves(const ChessCore::ChessBoard& board, ChessCore::MoveList<218>& moves, uint8_t ply, ChessCore::Move ttMove = 0, ChessCore::Move pvMove = 0);
 
-	float PrincipalVariationSearch(ChessCore::ChessBoard& board, float alpha, float beta, int depth, uint8_t ply);
-	float QuiescenceSearch(ChessCore::ChessBoard& board, float alpha, float beta, uint8_t ply);
+	// Move ordering history, see the tables below
+	using PieceToHistory = std::array<std::array<int16_t, 64>, 12>;
+	int GetContinuationIndex(uint8_t ply, uint8_t pliesBack) const;
+	int GetQuietHistory(ChessCore::Move move, uint8_t ply) const;
+	void UpdateQuietHistory(ChessCore::Move move, uint8_t ply, int bonus);
+	int16_t& GetCaptureHistory(const ChessCore::ChessBoard& board, ChessCore::Move move);
+	void UpdateHistories(const ChessCore::ChessBoard& board, ChessCore::Move bestMove, uint8_t ply, int depth,
+		const ChessCore::MoveList<218>& quietsTried, const ChessCore::MoveList<218>& capturesTried);
+	void AgeHistories();
+	void ClearHistories();
 
-	float EvaluateBoard(const ChessCore::ChessBoard& board);
-	float FastStaticEval(const ChessCore::ChessBoard& board);
-	float EvaluateTerminal(const ChessCore::ChessBoard& board);
+	static bool IsQuietMove(ChessCore::Move move) { return !(move.GetMoveFlags() & (ChessCore::MoveFlags::IS_CAPTURE | ChessCore::MoveFlags::IS_PROMOTION)); }
+	static int HistoryBonus(int depth) { return std::min(c_HistoryBonusPerDepth * depth * depth, c_MaxHistoryBonus); }
 
-	bool PositiveSEE(const ChessCore::ChessBoard& board, ChessCore::Move move);
+	// Gravity: the entry moves towards +-c_HistoryMax by bonus, slower the closer it already is
+	static void UpdateHistoryEntry(int16_t& entry, int bonus) { entry += (int16_t)(bonus - entry * std::abs(bonus) / c_HistoryMax); }
 
-	void SortMoves(const ChessCore::ChessBoard& board, ChessCore::MoveList<218>& moves, uint8_t ply, ChessCore::Move ttMove = 0);
+	void UpdatePV(uint8_t ply, ChessCore::Move move);
+	ChessCore::Move GetPVMove(const ChessCore::MoveList<218>& moves, uint8_t ply);
 
-	int LateMoveReduction(int depth, uint8_t ply, uint8_t moveIndex) const;
+	int LateMoveReduction(int depth, uint8_t moveIndex, int history, bool isPVNode, bool improving) const;
+	bool IsImproving(uint8_t ply) const;
+	int MoveExtension(const ChessCore::ChessBoard& board, ChessCore::Move move, ChessCore::Move singularMove, uint8_t ply) const;
+
+	// Mate scores are relative to the root while searching and relative to the node in the tt
+	static int16_t ScoreToTT(int score, uint8_t ply);
+	static int ScoreFromTT(int score, uint8_t ply);
 
 	bool IsTimeUp();
+
+	// Fills in the totals and hands a copy to GetSearchStats
+	void PublishStats();
+	bool IsStopped() const { return m_StopSearching.load(std::memory_order_relaxed); }
 	inline int NullMoveReduction(int depth) { return 2 + (depth >= 6 ? 1 : 0); }
 
+	// Root window (centipawns) around the last iteration's score, doubled on every fail
+	static constexpr int c_AspirationWindow = 50;
+	static constexpr int c_AspirationMinDepth = 4;
+
+	// From this depth on a null move cutoff is only trusted after a reduced search without null moves agrees
+	static constexpr int c_NullMoveVerificationDepth = 6;
+
+	// Late move reductions, base reduction from s_LateMoveReductions[depth][moveIndex] of the form
+	// c_LMRBase + log(depth) * log(moveIndex) / c_LMRDivisor, a move's history takes off one ply per c_LMRHistoryDivisor
+	static constexpr float c_LMRBase = 1.f;
+	static constexpr float c_LMRDivisor = 1.5f;
+	static constexpr int c_LMRHistoryDivisor = 8192;
+	static constexpr int c_LMRMinDepth = 2;
+	static constexpr int c_LMRMinMoveIndex = 3;
+	static const std::array<std::array<uint8_t, 64>, 64> s_LateMoveReductions;
+
+	// A tt move is singular if every other move fails low against its tt score minus the margin
+	// in a search of half the depth, it then gets searched one ply deeper
+	static constexpr int c_SingularMinDepth = 6;
+	static constexpr int c_SingularMarginPerDepth = 2;
+
+	// A quiet move is pruned if the eval after it plus this margin per ply still can't reach alpha
+	static constexpr int c_FutilityMarginPerPly = 50;
+
+	// History entries stay within +-c_HistoryMax, a cutoff at depth d is worth min(c_HistoryBonusPerDepth * d * d, c_MaxHistoryBonus)
+	static constexpr int c_HistoryMax = 16384;
+	static constexpr int c_HistoryBonusPerDepth = 32;
+	static constexpr int c_MaxHistoryBonus = 1200;
+
 
 private:
 
@@ -62,166 +160,86 @@ private:
 		-1000.f	// BLACK_KING
 	};
 
-	static inline const std::array<std::array<float, 64>, 6> c_MGPieceSquareTables = {
-		// WHITE_PAWN
-		std::array<float, 64>{
-			  0,   0,   0,   0,   0,   0,  0,   0,
-			 98, 134,  61,  95,  68, 126, 34, -11,
-			 -6,   7,  26,  31,  65,  56, 25, -20,
-			-14,  13,   6,  21,  23,  12, 17, -23,
-			-27,  -2,  -5,  12,  17,   6, 10, -25,
-			-26,  -4,  -4, -10,   3,   3, 33, -12,
-			-35,  -1, -20, -23, -15,  24, 38, -22,
-			  0,   0,   0,   0,   0,   0,  0,   0,
-		},
-		std::array<float, 64>{
-			-167, -89, -34, -49,  61, -97, -15, -107,
-			 -73, -41,  72,  36,  23,  62,   7,  -17,
-			 -47,  60,  37,  65,  84, 129,  73,   44,
-			  -9,  17,  19,  53,  37,  69,  18,   22,
-			 -13,   4,  16,  13,  28,  19,  21,   -8,
-			 -23,  -9,  12,  10,  19,  17,  25,  -16,
-			 -29, -53, -12,  -3,  -1,  18, -14,  -19,
-			-105, -21, -58, -33, -17, -28, -19,  -23,
-		},
-		std::array<float, 64>{
-			-29,   4, -82, -37, -25, -42,   7,  -8,
-			-26,  16, -18, -13,  30,  59,  18, -47,
-			-16,  37,  43,  40,  35,  50,  37,  -2,
-			 -4,   5,  19,  50,  37,  37,   7,  -2,
-			 -6,  13,  13,  26,  34,  12,  10,   4,
-			  0,  15,  15,  15,  14,  27,  18,  10,
-			  4,  15,  16,   0,   7,  21,  33,   1,
-			-33,  -3, -14, -21, -13, -12, -39, -21,
-		},
-		std::array<float, 64>{
-			 32,  42,  32,  51, 63,  9,  31,  43,
-			 27,  32,  58,  62, 80, 67,  26,  44,
-			 -5,  19,  26,  36, 17, 45,  61,  16,
-			-24, -11,   7,  26, 24, 35,  -8, -20,
-			-36, -26, -12,  -1,  9, -7,   6, -23,
-			-45, -25, -16, -17,  3,  0,  -5, -33,
-			-44, -16, -20,  -9, -1, 11,  -6, -71,
-			-19, -13,   1,  17, 16,  7, -37, -26,
-		},
-		std::array<float, 64> {
-			-28,   0,  29,  12,  59,  44,  43,  45,
-			-24, -39,  -5,   1, -16,  57,  28,  54,
-			-13, -17,   7,   8,  29,  56,  47,  57,
-			-27, -27, -16, -16,  -1,  17,  -2,   1,
-			 -9, -26,  -9, -10,  -2,  -4,   3,  -3,
-			-14,   2, -11,  -2,  -5,   2,  14,   5,
-			-35,  -8,  11,   2,   8,  15,  -3,   1,
-			 -1, -18,  -9,  10, -15, -25, -31, -50,
-		},
-		std::array<float, 64>{
-			-65,  23,  16, -15, -56, -34,   2,  13,
-			 29,  -1, -20,  -7,  -8,  -4, -38, -29,
-			 -9,  24,   2, -16, -20,   6,  22, -22,
-			-17, -20, -12, -27, -30, -25, -14, -36,
-			-49,  -1, -27, -39, -46, -44, -33, -51,
-			-14, -14, -22, -46, -44, -30, -15, -27,
-			  1,   7,  -8, -64, -43, -16,   9,   8,
-			-15,  36,  12, -54,   8, -28,  24,  14,
-		},
-	};
+	// Centipawn piece values for static exchange evaluation, indexed by piece type % 6
+	static constexpr int c_SEEPieceValues[6] = { 100, 300, 300, 500, 900, 20000 };
 
-	static inline const std::array<std::array<float, 64>, 6> c_EGPieceSquareTables = {
-		// WHITE_PAWN
-		std::array<float, 64>{
-			  0,   0,   0,   0,   0,   0,   0,   0,
-			178, 173, 158, 134, 147, 132, 165, 187,
-			 94, 100,  85,  67,  56,  53,  82,  84,
-			 32,  24,  13,   5,  -2,   4,  17,  17,
-			 13,   9,  -3,  -7,  -7,  -8,   3,  -1,
-			  4,   7,  -6,   1,   0,  -5,  -1,  -8,
-			 13,   8,   8,  10,  13,   0,   2,  -7,
-			  0,   0,   0,   0,   0,   0,   0,   0,
-		},
-		std::array<float, 64>{
-			-58, -38, -13, -28, -31, -27, -63, -99,
-			-25,  -8, -25,  -2,  -9, -25, -24, -52,
-			-24, -20,  10,   9,  -1,  -9, -19, -41,
-			-17,   3,  22,  22,  22,  11,   8, -18,
-			-18,  -6,  16,  25,  16,  17,   4, -18,
-			-23,  -3,  -1,  15,  10,  -3, -20, -22,
-			-42, -20, -10,  -5,  -2, -20, -23, -44,
-			-29, -51, -23, -15, -22, -18, -50, -64,
-		},
-		std::array<float, 64>{
-			-14, -21, -11,  -8, -7,  -9, -17, -24,
-			 -8,  -4,   7, -12, -3, -13,  -4, -14,
-			  2,  -8,   0,  -1, -2,   6,   0,   4,
-			 -3,   9,  12,   9, 14,  10,   3,   2,
-			 -6,   3,  13,  19,  7,  10,  -3,  -9,
-			-12,  -3,   8,  10, 13,   3,  -7, -15,
-			-14, -18,  -7,  -1,  4,  -9, -15, -27,
-			-23,  -9, -23,  -5, -9, -16,  -5, -17,
-		},
-		std::array<float, 64>{
-			13, 10, 18, 15, 12,  12,   8,   5,
-			11, 13, 13, 11, -3,   3,   8,   3,
-			 7,  7,  7,  5,  4,  -3,  -5,  -3,
-			 4,  3, 13,  1,  2,   1,  -1,   2,
-			 3,  5,  8,  4, -5,  -6,  -8, -11,
-			-4,  0, -5, -1, -7, -12,  -8, -16,
-			-6, -6,  0,  2, -9,  -9, -11,  -3,
-			-9,  2,  3, -1, -5, -13,   4, -20,
-		},
-		std::array<float, 64>{
-			 -9,  22,  22,  27,  27,  19,  10,  20,
-			-17,  20,  32,  41,  58,  25,  30,   0,
-			-20,   6,   9,  49,  47,  35,  19,   9,
-			  3,  22,  24,  45,  57,  40,  57,  36,
-			-18,  28,  19,  47,  31,  34,  39,  23,
-			-16, -27,  15,   6,   9,  17,  10,   5,
-			-22, -23, -30, -16, -16, -23, -36, -32,
-			-33, -28, -22, -43,  -5, -32, -20, -41,
-		},
-		std::array<float, 64>{
-			-74, -35, -18, -18, -11,  15,   4, -17,
-			-12,  17,  14,  17,  17,  38,  23,  11,
-			 10,  17,  23,  15,  20,  45,  44,  13,
-			 -8,  22,  24,  27,  26,  33,  26,   3,
-			-18,  -4,  21,  24,  27,  23,   9, -11,
-			-19,  -3,  11,  21,  23,  16,   7,  -9,
-			-27, -11,   4,  13,  14,   4,  -5, -17,
-			-53, -34, -21, -11, -28, -14, -24, -43
-		}
-	};
-
-	static inline const std::string c_OpeningBookPath = "Ressources/OpeningBook/OpeningBook.txt";
-	std::ifstream m_OpeningBook;
+	// Binary book built by BookConverter, probed every move since a transposition can lead back into it
+	static inline const std::string c_OpeningBookPath = "Ressources/OpeningBook/OpeningBook.bin";
+	ChessCore::OpeningBook m_OpeningBook;
+	std::mt19937_64 m_BookRng{ std::random_device{}() };
+	bool m_UseOpeningBook = true;
 
 	// Timing Stuff
-	std::chrono::time_point<std::chrono::steady_clock> m_SearchStartTime;
-	std::chrono::seconds m_TimeLimitS{ 15 };
-	std::atomic<bool> m_TimeUp{ false };
+	TimeManager m_TimeManager;
+	static constexpr uint32_t c_TimeCheckInterval = 2048;
+	uint32_t m_TimeCheckCountdown = c_TimeCheckInterval;
 
 	// AI Stuff
-	NeuralNetwork m_NeuralNetwork;
+	std::unique_ptr<NeuralNetwork> m_NeuralNetwork;
+	static constexpr int c_NetworkScale = 50; // network output is in pawns, weighted at half the static eval
+	int m_LazyEvalMargin = 200;
+	EvalBackend m_EvalBackend = EvalBackend::NEURAL_NETWORK;
 
 	// Transpotision Table
-	TranspositionTable m_TranspositionTable{ 256 }; // 256 MB
+	TranspositionTable m_TranspositionTable;
+
+	// Principal Variation, row ply holds the line from ply on
+	static constexpr uint8_t c_MaxPly = 100;
+
+	// Being mated in n plies from the root scores -c_MateScore + n, every score beyond c_MateBound is a mate
+	static constexpr int c_MateScore = 31'000;
+	static constexpr int c_MateBound = c_MateScore - c_MaxPly;
+	ChessCore::Move m_PVTable[c_MaxPly][c_MaxPly] = {};
+	uint8_t m_PVLength[c_MaxPly] = {};
 
-	// Search Heuristics
+	// Last completed iteration's PV, searched first while the search is still on it
+	ChessCore::Move m_PreviousPV[c_MaxPly] = {};
+	uint8_t m_PreviousPVLength = 0;
+	bool m_FollowPV = false;
+
+	// Static eval of every node on the current line, INF when in check
+	int m_PlyStaticEval[c_MaxPly] = {};
+
+	// Search Heuristics, all of them belong to this bot and the thread it searches on
 	ChessCore::Move m_KillerMoves[100][2] = {};
-	int m_HistoryHeuristic[64][64] = {};
 
-	// Opening book
-	bool m_OpeningBookAvailable = true;
+	// Move made at every ply of the current line, 0 for a null move
+	ChessCore::Move m_PlyMoves[c_MaxPly] = {};
 
-	// Debug Info
-	uint64_t m_NodesSearched = 0;
-	uint64_t m_QuiescenceNodesSearched = 0;
-	uint64_t m_NodesEvaluated = 0;
+	// Quiet moves by side, from and to square
+	int16_t m_ButterflyHistory[2][64][64] = {};
+
+	// Quiet moves (piece, to) by the move one and two plies earlier, c_ContinuationCount tables indexed by piece * 64 + to
+	static constexpr size_t c_ContinuationCount = 12 * 64;
+	std::vector<PieceToHistory> m_ContinuationHistory = std::vector<PieceToHistory>(c_ContinuationCount);
+
+	// Quiet reply that refuted the previous move, by its piece and to square
+	ChessCore::Move m_CounterMoves[12][64] = {};
 
+	// Captures by moving piece, to square and captured piece type
+	int16_t m_CaptureHistory[12][64][6] = {};
+
+	// Search Statistics, m_NodesSearched also drives the node limit
+	uint64_t m_NodesSearched = 0;
 	uint64_t m_NodesAtDepth[200] = {};
+	SearchStats m_Stats;
+	uint64_t m_CacheHitsAtSearchStart = 0;
+
+	// Snapshot for other threads, published between iterations
+	mutable std::mutex m_PublishedStatsMutex;
+	SearchStats m_PublishedStats;
+	std::ofstream m_StatsLog;
 
 	// Misc
 	uint32_t m_CurrentDepth{ 1 };
+	int m_RootScore = 0;
+	int m_LastScore = 0;
+	uint64_t m_NodeLimit = 0;
+	bool m_Verbose = true;
 	uint32_t m_SearchID = 0;
-	std::atomic<bool> m_StopSearching;
+
+	// Set when the hard time limit is hit or from another thread through StopSearching
+	std::atomic<bool> m_StopSearching{ false };
 
 };
 
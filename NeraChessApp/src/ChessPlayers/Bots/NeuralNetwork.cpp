@@ -1,36 +1,73 @@
 #include "NeuralNetwork.h"
 
-#include <filesystem>
+#include "ChessUtil.h"
+
+#include <algorithm>
 #include <print>
 #include <thread>
+#include <chrono>
+#include <random>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Writes one 8x8 plane (64 floats) with 16 byte stores
+	inline void FillPlane(float* plane, float value)
+	{
+#if defined(__SSE2__) || defined(_M_X64)
+		const __m128 fill = _mm_set1_ps(value);
+		for (int i = 0; i < 64; i += 4)
+			_mm_storeu_ps(plane + i, fill);
+#else
+		std::fill(plane, plane + 64, value);
+#endif
+	}
+}
 
-NeuralNetwork::NeuralNetwork(const std::string& modelPath)
+NeuralNetwork::NeuralNetwork(const std::string& modelPath, const InferenceConfig& config)
+	: m_BatchSize(std::max<size_t>(config.MaxBatchSize, 1))
 {
-	if (std::filesystem::exists(modelPath))
-		std::println("Model found");
-	else
+	m_Model = ModelRegistry::Acquire(modelPath, config);
+	if (!m_Model)
 	{
-		std::println("Model missing ({})", modelPath);
 		assert(false);
 		return;
 	}
 
-	// Initialization of OnnxRuntime
-	std::wstring wide(modelPath.begin(), modelPath.end());
-	const wchar_t* wmodelPath = wide.c_str();
-	m_SessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
-	m_SessionOptions.SetIntraOpNumThreads(std::thread::hardware_concurrency());
-
-	//m_CudaOptions.arena_extend_strategy = 0;
-	//m_CudaOptions.cudnn_conv_algo_search = OrtCudnnConvAlgoSearchHeuristic;
-	//m_CudaOptions.do_copy_in_default_stream = 1;
-	//
-	//m_SessionOptions.AppendExecutionProvider_CUDA(m_CudaOptions);
-	m_Session = Ort::Session(m_Env, wmodelPath, m_SessionOptions);
-
 	m_InputBuffer.resize(m_BatchSize * c_InputTensorSize);
+	m_OutputBuffer.resize(m_BatchSize);
+	m_SlotStates.resize(m_BatchSize);
 	m_InfoVector.reserve(m_BatchSize);
 
+	m_InputTensors.reserve(m_BatchSize);
+	m_OutputTensors.reserve(m_BatchSize);
+	m_Bindings.reserve(m_BatchSize);
+
+	for (size_t batchSize = 1; batchSize <= m_BatchSize; batchSize++)
+	{
+		const std::array<int64_t, 4> inputShape = { (int64_t)batchSize, c_NumChannels, c_BoardSize, c_BoardSize };
+		const std::array<int64_t, 2> outputShape = { (int64_t)batchSize, 1 };
+
+		m_InputTensors.push_back(Ort::Value::CreateTensor<float>(
+			m_MemoryInfo,
+			m_InputBuffer.data(), batchSize * c_InputTensorSize,
+			inputShape.data(), inputShape.size()
+		));
+
+		m_OutputTensors.push_back(Ort::Value::CreateTensor<float>(
+			m_MemoryInfo,
+			m_OutputBuffer.data(), batchSize,
+			outputShape.data(), outputShape.size()
+		));
+
+		Ort::IoBinding& binding = m_Bindings.emplace_back(m_Model->GetSession());
+		binding.BindInput(m_InputName, m_InputTensors.back());
+		binding.BindOutput(m_OutputName, m_OutputTensors.back());
+	}
+
 	//ChessCore::ChessBoard board{"r1b1kb1r/1pp2ppp/p1p2n2/8/3qP3/P1N2N2/1PP2PPP/R1B1K2R w KQkq - 0 9"};
 
 	//std::print("Evaluation of position: {}", GetEvaluation(board));
@@ -39,10 +76,17 @@ NeuralNetwork::NeuralNetwork(const std::string& modelPath)
 
 }
 
+NeuralNetwork::NeuralNetwork(size_t batchSize)
+	: m_BatchSize(std::max<size_t>(batchSize, 1))
+{
+	m_InputBuffer.resize(m_BatchSize * c_InputTensorSize);
+	m_SlotStates.resize(m_BatchSize);
+}
+
 NeuralNetwork::~NeuralNetwork()
 {
-	m_Session.release();
-	m_Env.release();
+	// bindings reference the session, drop them before the model can be unloaded
+	m_Bindings.clear();
 }
 
 float NeuralNetwork::GetEvaluation(const ChessCore::ChessBoard& board)
@@ -57,16 +101,20 @@ void NeuralNetwork::QueuePosition(const ChessCore::ChessBoard& board)
 	for (BoardInfo& info : m_InfoVector)
 	{
 		if (info.ZobristKey == board.GetZobristKey())
+		{
+			m_CacheHits++;
 			return;
+		}
 	}
 
 	auto cacheIt = s_EvaluationCache.find(board.GetZobristKey());
 	if (cacheIt != s_EvaluationCache.end())
+	{
+		m_CacheHits++;
 		return;
+	}
 
-	float* pos = &m_InputBuffer[m_InfoVector.size() * c_InputTensorSize];
-
-	BoardToTensor(board, pos);
+	BoardToTensor(board, m_InfoVector.size());
 
 	m_InfoVector.emplace_back(board.GetZobristKey(), board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove));
 
@@ -74,87 +122,220 @@ void NeuralNetwork::QueuePosition(const ChessCore::ChessBoard& board)
 		EvaluateQueue();
 }
 
-void NeuralNetwork::BoardToTensor(const ChessCore::ChessBoard& board, float* out) const
+void NeuralNetwork::BoardToTensor(const ChessCore::ChessBoard& board, size_t slot)
 {
+	float* out = &m_InputBuffer[slot * c_InputTensorSize];
+	SlotState& state = m_SlotStates[slot];
 
 	const ChessCore::BoardState& boardState = board.GetBoardState();
 
-	for (ChessCore::Square square = 0; square < 64; square++)
+	// clear what the previous position in this slot left behind
+	uint64_t stalePlanes = state.SparsePlanes;
+	while (stalePlanes)
 	{
-		ChessCore::Piece piece = board.GetPiece(square);
-		if (piece != ChessCore::PieceType::NO_PIECE)
-		{
-			uint8_t file = square.GetFile();
-			uint8_t rank = square.GetRank();
+		uint8_t plane = ChessCore::BitUtil::PopLSB(stalePlanes);
+		FillPlane(&out[plane * c_PlaneSize], 0.0f);
+	}
+	state.SparsePlanes = 0;
+
+	// pieces, layout is [piece][file][rank]
+	for (uint8_t piece = ChessCore::PieceType::WHITE_PAWN; piece <= ChessCore::PieceType::BLACK_KING; piece++)
+	{
+		ChessCore::Bitboard pieces = boardState.pieceBitboards[piece];
+		if (!pieces)
+			continue;
+
+		state.SparsePlanes |= 1u << piece;
 
-			out[piece * 64 + file * 8 + rank] = 1.0f;
+		float* plane = &out[piece * c_PlaneSize];
+		while (pieces)
+		{
+			uint8_t square = ChessCore::BitUtil::PopLSB(pieces);
+			plane[(square & 7) * 8 + (square >> 3)] = 1.0f;
 		}
 	}
 
-	if (boardState.HasFlag(ChessCore::BoardStateFlags::WhiteToMove))
+	// en passant, fill only that file
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanEnPassent) && boardState.enPassantFile <= 7)
 	{
-		float* ptr = &out[12 * 64];
-		std::fill(ptr, ptr + 64, 1.0f);
+		state.SparsePlanes |= 1u << c_EnPassantPlane;
+
+		float* ptr = &out[c_EnPassantPlane * c_PlaneSize + boardState.enPassantFile * 8];
+		std::fill(ptr, ptr + 8, 1.0f);
 	}
 
-	auto fill_castle = [&](int channel)
-		{
-			float* ptr = &out[channel * 64];
-			std::fill(ptr, ptr + 64, 1.0f);
-		};
+	// side to move, castling rights and half move clock are the same on every square,
+	// so they are only rewritten when they differ from what the slot already holds
+	const std::array<float, 6> broadcastValues = {
+		boardState.HasFlag(ChessCore::BoardStateFlags::WhiteToMove) ? 1.0f : 0.0f,
+		boardState.HasFlag(ChessCore::BoardStateFlags::CanWhiteCastleKing) ? 1.0f : 0.0f,
+		boardState.HasFlag(ChessCore::BoardStateFlags::CanWhiteCastleQueen) ? 1.0f : 0.0f,
+		boardState.HasFlag(ChessCore::BoardStateFlags::CanBlackCastleKing) ? 1.0f : 0.0f,
+		boardState.HasFlag(ChessCore::BoardStateFlags::CanBlackCastleQueen) ? 1.0f : 0.0f,
+		static_cast<float>(board.GetHalfMoveClock()) / 50.0f, // halfmove clock normalized
+	};
+
+	for (size_t i = 0; i < c_BroadcastPlanes.size(); i++)
+	{
+		if (state.BroadcastValues[i] == broadcastValues[i])
+			continue;
+
+		FillPlane(&out[c_BroadcastPlanes[i] * c_PlaneSize], broadcastValues[i]);
+		state.BroadcastValues[i] = broadcastValues[i];
+	}
+}
+
+void NeuralNetwork::EvaluateQueue()
+{
+	if (m_InfoVector.size() == 0)
+		return;
+
+	RunBatch(m_InfoVector.size());
+
+	for (int i{ 0 }; i < m_InfoVector.size(); i++)
+	{
+		const float perspectiveEval = m_OutputBuffer[i] * float(m_InfoVector[i].WhiteToMove ? 1.f : -1.f);
+
+		s_EvaluationCache[m_InfoVector[i].ZobristKey] = perspectiveEval;
+	}
+
+	m_InfoVector.clear();
+}
+
+void NeuralNetwork::EvaluateBatch(const ChessCore::ChessBoard* boards, size_t count, float* scores)
+{
+	count = std::min(count, m_BatchSize);
+	if (!m_Model || count == 0)
+		return;
 
-	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanWhiteCastleKing)) fill_castle(13);
-	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanWhiteCastleQueen)) fill_castle(14);
-	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanBlackCastleKing)) fill_castle(15);
-	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanBlackCastleQueen)) fill_castle(16);
+	for (size_t slot = 0; slot < count; slot++)
+		BoardToTensor(boards[slot], slot);
+
+	RunBatch(count);
+
+	std::copy(m_OutputBuffer.begin(), m_OutputBuffer.begin() + count, scores);
+}
+
+void NeuralNetwork::RunBatch(size_t batchSize)
+{
+	m_Model->GetSession().Run(m_RunOptions, m_Bindings[batchSize - 1]);
+}
 
-	// en passant
-	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanEnPassent))
+void NeuralNetwork::RunBenchmark(const std::string& modelPath, const InferenceConfig& config, int runsPerBatchSize)
+{
+	constexpr std::array<size_t, 4> batchSizes = { 1, 8, 32, 128 };
+
+	InferenceConfig benchConfig = config;
+	benchConfig.MaxBatchSize = (uint16_t)batchSizes.back();
+
+	NeuralNetwork network(modelPath, benchConfig);
+
+	// fill every slot with a position from a random game, so the numbers are not from an empty board
+	std::mt19937 rng(42);
+	ChessCore::ChessBoard board;
+	for (size_t slot = 0; slot < network.m_BatchSize; slot++)
 	{
-		uint8_t file = boardState.enPassantFile;
-		if (file >= 0 && file <= 7)
+		ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
+		if (legalMoves.size() == 0 || board.GetHalfMoveClock() >= 50)
 		{
-			float* ptr = &out[17 * 64 + file * 8];
-			std::fill(ptr, ptr + 8, 1.0f); // fill only that file
+			board = ChessCore::ChessBoard();
+			legalMoves = board.GetLegalMoves();
 		}
+
+		board.MakeMove(legalMoves[rng() % legalMoves.size()], true);
+		network.BoardToTensor(board, slot);
 	}
 
-	// halfmove clock normalized
-	float val = static_cast<float>(board.GetHalfMoveClock()) / 50.0f;
-	float* ptr = &out[18 * 64];
-	std::fill(ptr, ptr + 64, val);
+	std::println("Inference benchmark (intra-op {}, inter-op {}, global pool {}, spinning {})",
+		config.IntraOpThreads, config.InterOpThreads, config.UseGlobalThreadPool, config.AllowSpinning);
+
+	for (size_t batchSize : batchSizes)
+	{
+		// warm up, the first runs allocate OnnxRuntime's internal buffers
+		for (int i = 0; i < 5; i++)
+			network.RunBatch(batchSize);
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < runsPerBatchSize; i++)
+			network.RunBatch(batchSize);
 
+		auto end = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(end - start).count();
+
+		double callsPerSecond = runsPerBatchSize / seconds;
+		std::println("Batch {:>3}: {:>10.1f} calls/s, {:>12.1f} positions/s",
+			batchSize, callsPerSecond, callsPerSecond * batchSize);
+	}
 }
 
-void NeuralNetwork::EvaluateQueue()
+void NeuralNetwork::ReferenceBoardToTensor(const ChessCore::ChessBoard& board, float* out)
 {
-	if (m_InfoVector.size() == 0)
-		return;
+	const ChessCore::BoardState& boardState = board.GetBoardState();
 
-	m_InputShape[0] = m_InfoVector.size();
+	for (ChessCore::Square square = 0; square < 64; square++)
+	{
+		ChessCore::Piece piece = board.GetPiece(square);
+		if (piece != ChessCore::PieceType::NO_PIECE)
+			out[piece * c_PlaneSize + square.GetFile() * c_BoardSize + square.GetRank()] = 1.0f;
+	}
 
-	Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-		m_MemoryInfo,
-		m_InputBuffer.data(), m_InfoVector.size() * c_InputTensorSize,
-		m_InputShape.data(), m_InputShape.size()
-	);
+	auto fillPlane = [&](int plane, float value)
+		{
+			std::fill(&out[plane * c_PlaneSize], &out[(plane + 1) * c_PlaneSize], value);
+		};
 
-	const char* output_names[] = { "output" };
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::WhiteToMove)) fillPlane(12, 1.0f);
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanWhiteCastleKing)) fillPlane(13, 1.0f);
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanWhiteCastleQueen)) fillPlane(14, 1.0f);
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanBlackCastleKing)) fillPlane(15, 1.0f);
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanBlackCastleQueen)) fillPlane(16, 1.0f);
 
-	std::vector<Ort::Value> outputVector = m_Session.Run(
-		Ort::RunOptions{ nullptr },
-		&m_InputName, &inputTensor, 1,
-		&m_OutputName,	1
-	);
+	// en passant, only that file
+	if (boardState.HasFlag(ChessCore::BoardStateFlags::CanEnPassent) && boardState.enPassantFile <= 7)
+		std::fill(&out[c_EnPassantPlane * c_PlaneSize + boardState.enPassantFile * 8], &out[c_EnPassantPlane * c_PlaneSize + boardState.enPassantFile * 8 + 8], 1.0f);
 
-	const float* const eval = outputVector.front().GetTensorData<float>();
+	fillPlane(18, static_cast<float>(board.GetHalfMoveClock()) / 50.0f);
+}
 
-	for (int i{ 0 }; i < m_InfoVector.size(); i++)
+bool NeuralNetwork::RunEncoderCheck(int positions, size_t batchSize)
+{
+	NeuralNetwork encoder(batchSize);
+
+	std::mt19937 rng(42);
+	ChessCore::ChessBoard board;
+	std::array<float, c_InputTensorSize> expected;
+
+	int mismatches = 0;
+	int enPassantPositions = 0;
+	for (int i = 0; i < positions; i++)
 	{
-		const float perspectiveEval = eval[i] * float(m_InfoVector[i].WhiteToMove ? 1.f : -1.f);
+		ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
+		if (legalMoves.size() == 0 || board.GetHalfMoveClock() >= 50)
+		{
+			board = ChessCore::ChessBoard();
+			legalMoves = board.GetLegalMoves();
+		}
 
-		s_EvaluationCache[m_InfoVector[i].ZobristKey] = perspectiveEval;
+		board.MakeMove(legalMoves[rng() % legalMoves.size()], true);
+		enPassantPositions += board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::CanEnPassent);
+
+		// a random slot, so every slot gets overwritten by positions that differ from what it held
+		const size_t slot = rng() % encoder.m_BatchSize;
+		encoder.BoardToTensor(board, slot);
+
+		expected.fill(0.0f);
+		ReferenceBoardToTensor(board, expected.data());
+
+		if (!std::equal(expected.begin(), expected.end(), encoder.m_InputBuffer.begin() + slot * c_InputTensorSize))
+		{
+			if (mismatches < 5)
+				std::println("Encoder mismatch in slot {}: {}", slot, board.GetFENString());
+			mismatches++;
+		}
 	}
 
-	m_InfoVector.clear();
+	std::println("Encoder check: {} of {} positions differ from the reference layout ({} with en passant, {} slots)",
+		mismatches, positions, enPassantPositions, encoder.m_BatchSize);
+	return mismatches == 0;
 }
@@ -2,26 +2,57 @@
 
 #include "ChessBoard.h"
 
+#include "ModelRegistry.h"
+
 #include "onnxruntime_cxx_api.h"
 
 #include <string>
+#include <array>
+#include <vector>
+#include <memory>
 
+// Per player / per search thread front end to a SharedModel, owns the input
+// and output buffers, so it must not be used from more than one thread at a time
 class NeuralNetwork
 {
 public:
-	NeuralNetwork(const std::string& modelPath);
+	NeuralNetwork(const std::string& modelPath, const InferenceConfig& config = {});
 	~NeuralNetwork();
 
 	float GetEvaluation(const ChessCore::ChessBoard& board);
 
 	void QueuePosition(const ChessCore::ChessBoard& board);
 
+	// Runs up to GetBatchSize() boards as one batch, past the cache. Shares the input slots with the queue, so nothing may be queued.
+	// scores gets the raw network output, in pawns from white's point of view
+	void EvaluateBatch(const ChessCore::ChessBoard* boards, size_t count, float* scores);
+
+	bool IsLoaded() const { return m_Model != nullptr; }
+	size_t GetBatchSize() const { return m_BatchSize; }
+
+	// Positions answered from the cache or an already queued slot instead of a new inference
+	uint64_t GetCacheHits() const { return m_CacheHits; }
+
+	static void RunBenchmark(const std::string& modelPath, const InferenceConfig& config = {}, int runsPerBatchSize = 200);
+
+	// Encodes positions from random games into randomly reused batch slots and compares every tensor
+	// with the plain GetPiece based layout, needs no model. True when all of them match
+	static bool RunEncoderCheck(int positions = 2000, size_t batchSize = 32);
+
 private:
 
-	void BoardToTensor(const ChessCore::ChessBoard& board, float* out) const;
+	// Only the input buffer and slot states, for RunEncoderCheck
+	explicit NeuralNetwork(size_t batchSize);
+
+	// Reference layout the sparse encoder has to reproduce, out has to be zeroed
+	static void ReferenceBoardToTensor(const ChessCore::ChessBoard& board, float* out);
+
+	void BoardToTensor(const ChessCore::ChessBoard& board, size_t slot);
 
 	void EvaluateQueue();
 
+	void RunBatch(size_t batchSize);
+
 private:
 
 	struct BoardInfo
@@ -30,33 +61,48 @@ private:
 		bool WhiteToMove{ true };
 	};
 
+	// What a batch slot in m_InputBuffer currently holds, so a new position
+	// only has to clear the planes the previous one wrote to
+	struct SlotState
+	{
+		uint32_t SparsePlanes{ 0 }; // bit per piece / en passant plane that has set squares
+		std::array<float, 6> BroadcastValues{}; // side to move, castling x4, half move clock
+	};
+
 	// Const stuff
 	static inline const int c_BoardSize = 8;
+	static inline const int c_PlaneSize = c_BoardSize * c_BoardSize;
+	static inline const int c_EnPassantPlane = 17;
+	static inline const std::array<int, 6> c_BroadcastPlanes = { 12, 13, 14, 15, 16, 18 };
 	static inline const int64_t c_NumChannels = 19;
 	static inline const int64_t c_InputTensorSize = 1 * c_NumChannels * c_BoardSize * c_BoardSize;
 
-	std::array<int64_t, 4> m_InputShape = { 1, c_NumChannels, c_BoardSize, c_BoardSize };
-	std::array<int64_t, 2> m_OutputShape = { 1, 1 };
-
 	const char* m_InputName = "input";
 	const char* m_OutputName = "output";
 
-	uint8_t m_BatchSize = 32;
+	size_t m_BatchSize = 32;
 
 	// Ort
-	Ort::Env m_Env{ ORT_LOGGING_LEVEL_WARNING, "NeraChessBot" };
-	Ort::SessionOptions m_SessionOptions;
-	OrtCUDAProviderOptions m_CudaOptions;
-	Ort::Session m_Session{ nullptr };
+	std::shared_ptr<SharedModel> m_Model;
 	Ort::MemoryInfo m_MemoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+	Ort::RunOptions m_RunOptions;
+
+	// One binding per batch size (index = size - 1), all viewing the front of
+	// m_InputBuffer / m_OutputBuffer, so a Run never allocates tensors
+	std::vector<Ort::Value> m_InputTensors;
+	std::vector<Ort::Value> m_OutputTensors;
+	std::vector<Ort::IoBinding> m_Bindings;
 
 	// Data
 	std::vector<float> m_InputBuffer;
+	std::vector<float> m_OutputBuffer;
+	std::vector<SlotState> m_SlotStates;
 	std::array<float, c_InputTensorSize> m_InputArray = {};
 
 	std::vector<BoardInfo> m_InfoVector;
 
 	// Cache
 	std::unordered_map<uint64_t, float> s_EvaluationCache;
+	uint64_t m_CacheHits = 0;
 
 };
@@ -0,0 +1,83 @@
+#include "SearchStats.h"
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+double SearchStats::GetBranchingFactor() const
+{
+	// Iterations that searched nothing (a single tt hit at the root) would break the mean
+	size_t first = 0;
+	while (first < iterations.size() && iterations[first].nodes == 0)
+		first++;
+
+	if (iterations.size() < first + 2 || iterations.back().nodes == 0)
+		return 0.0;
+
+	const double growth = (double)iterations.back().nodes / (double)iterations[first].nodes;
+	return std::pow(growth, 1.0 / (double)(iterations.size() - 1 - first));
+}
+
+std::string SearchStats::ToInfoString() const
+{
+	std::ostringstream stream;
+	stream << std::fixed << std::setprecision(1)
+		<< "info string depth " << (iterations.empty() ? 0 : (int)iterations.back().depth)
+		<< " nodes " << nodes
+		<< " nps " << GetNodesPerSecond()
+		<< " time " << milliseconds
+		<< " ebf " << std::setprecision(2) << GetBranchingFactor() << std::setprecision(1)
+		<< " qnodes% " << 100.0 * GetQuiescenceFraction()
+		<< " tthit% " << 100.0 * GetTTHitRate()
+		<< " ttcut " << ttCutoffs
+		<< " firstcut% " << 100.0 * GetFirstMoveCutoffRate()
+		<< " nn " << networkEvaluations
+		<< " nncache% " << 100.0 * GetNetworkCacheHitRate()
+		<< " nnskip " << networkEvaluationsSkipped
+		<< " lmr " << reducedSearches
+		<< " research% " << 100.0 * GetReSearchRate()
+		<< " nullcut " << nullMoveCutoffs
+		<< " singular " << singularExtensions
+		<< " futility " << futilityPruned
+		<< " badcaptures " << losingCapturesPruned;
+	return stream.str();
+}
+
+std::string SearchStats::ToJSON() const
+{
+	std::ostringstream stream;
+	stream << std::setprecision(4)
+		<< "{\"nodes\":" << nodes
+		<< ",\"quiescenceNodes\":" << quiescenceNodes
+		<< ",\"milliseconds\":" << milliseconds
+		<< ",\"nps\":" << GetNodesPerSecond()
+		<< ",\"branchingFactor\":" << GetBranchingFactor()
+		<< ",\"ttProbes\":" << ttProbes
+		<< ",\"ttHits\":" << ttHits
+		<< ",\"ttCutoffs\":" << ttCutoffs
+		<< ",\"betaCutoffs\":" << betaCutoffs
+		<< ",\"firstMoveCutoffs\":" << firstMoveCutoffs
+		<< ",\"networkEvaluations\":" << networkEvaluations
+		<< ",\"networkCacheHits\":" << networkCacheHits
+		<< ",\"networkEvaluationsSkipped\":" << networkEvaluationsSkipped
+		<< ",\"nullMoveCutoffs\":" << nullMoveCutoffs
+		<< ",\"singularExtensions\":" << singularExtensions
+		<< ",\"futilityPruned\":" << futilityPruned
+		<< ",\"losingCapturesPruned\":" << losingCapturesPruned
+		<< ",\"reducedSearches\":" << reducedSearches
+		<< ",\"reSearches\":" << reSearches
+		<< ",\"iterations\":[";
+
+	for (size_t i = 0; i < iterations.size(); i++)
+	{
+		const IterationStats& iteration = iterations[i];
+		stream << (i ? "," : "")
+			<< "{\"depth\":" << (int)iteration.depth
+			<< ",\"score\":" << iteration.score
+			<< ",\"nodes\":" << iteration.nodes
+			<< ",\"milliseconds\":" << iteration.milliseconds << "}";
+	}
+
+	stream << "]}";
+	return stream.str();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// The per node counters cost a little speed, Dist builds leave them out unless NERA_SEARCH_STATS is set.
+// Nodes and the iteration records are always kept
+#ifndef NERA_SEARCH_STATS
+	#ifdef DIST
+		#define NERA_SEARCH_STATS 0
+	#else
+		#define NERA_SEARCH_STATS 1
+	#endif
+#endif
+
+#if NERA_SEARCH_STATS
+	#define SEARCH_STAT(statement) statement
+#else
+	#define SEARCH_STAT(statement)
+#endif
+
+// One completed iteration of iterative deepening
+struct IterationStats
+{
+	uint8_t depth = 0;
+	int score = 0;
+	uint64_t nodes = 0;			// searched in this iteration alone
+	int64_t milliseconds = 0;	// time this iteration took
+};
+
+// Counters of one search (one GetNextMove), owned by the searching thread so nothing in here is atomic.
+// Other threads only ever see copies the bot publishes between iterations
+struct SearchStats
+{
+	uint64_t nodes = 0;
+	uint64_t quiescenceNodes = 0;
+
+	uint64_t ttProbes = 0;
+	uint64_t ttHits = 0;
+	uint64_t ttCutoffs = 0;
+
+	uint64_t betaCutoffs = 0;
+	uint64_t firstMoveCutoffs = 0;
+
+	uint64_t networkEvaluations = 0;		// EvaluateBoard calls that asked the network
+	uint64_t networkCacheHits = 0;			// of those, answered by the evaluation cache
+	uint64_t networkEvaluationsSkipped = 0;	// lazy eval
+
+	uint64_t nullMoveCutoffs = 0;
+	uint64_t singularExtensions = 0;
+	uint64_t futilityPruned = 0;
+	uint64_t losingCapturesPruned = 0;
+
+	uint64_t reducedSearches = 0;	// late move reductions
+	uint64_t reSearches = 0;		// reduced searches that beat alpha and were repeated at full depth
+
+	int64_t milliseconds = 0;
+	std::vector<IterationStats> iterations;
+
+	void Reset() { *this = SearchStats(); }
+
+	double GetTTHitRate() const { return Ratio(ttHits, ttProbes); }
+	double GetFirstMoveCutoffRate() const { return Ratio(firstMoveCutoffs, betaCutoffs); }
+	double GetQuiescenceFraction() const { return Ratio(quiescenceNodes, nodes); }
+	double GetNetworkCacheHitRate() const { return Ratio(networkCacheHits, networkEvaluations); }
+	double GetReSearchRate() const { return Ratio(reSearches, reducedSearches); }
+	uint64_t GetNodesPerSecond() const { return nodes * 1000 / (uint64_t)std::max<int64_t>(milliseconds, 1); }
+
+	// Geometric mean of how many more nodes each iteration took than the one before, 0 before depth 2
+	double GetBranchingFactor() const;
+
+	// Single line for "info string" output
+	std::string ToInfoString() const;
+
+	// One JSON object on a single line, with the iterations
+	std::string ToJSON() const;
+
+private:
+	static double Ratio(uint64_t part, uint64_t total) { return total ? (double)part / (double)total : 0.0; }
+};
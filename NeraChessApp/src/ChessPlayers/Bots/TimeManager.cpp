@@ -0,0 +1,87 @@
+#include "TimeManager.h"
+
+#include <algorithm>
+
+void TimeManager::StartSearch(const ChessCore::Clock& clock, bool whiteToMove, uint16_t fullMoves)
+{
+	m_StartTime = std::chrono::steady_clock::now();
+
+	const Duration remaining = std::max(clock.GetRemainingTime(whiteToMove) - c_MoveOverhead, Duration(1));
+	const Duration increment = clock.GetIncrement(whiteToMove);
+
+	// Expect fewer moves left the longer the game goes
+	const int movesToGo = std::clamp<int>(c_MaxMovesToGo - fullMoves / 2, c_MinMovesToGo, c_MaxMovesToGo);
+
+	m_SoftLimit = remaining / movesToGo + increment * 3 / 4;
+	m_HardLimit = std::min({ m_SoftLimit * 4, remaining / 3 + increment, remaining });
+
+	m_SoftLimit = std::min(m_SoftLimit, m_HardLimit);
+
+	ResetStability();
+}
+
+void TimeManager::StartSearch(Duration fixedTime)
+{
+	m_StartTime = std::chrono::steady_clock::now();
+
+	m_SoftLimit = fixedTime;
+	m_HardLimit = fixedTime;
+
+	ResetStability();
+}
+
+void TimeManager::OnIterationComplete(ChessCore::Move bestMove, int score)
+{
+	if (m_Iterations > 0)
+	{
+		// Changes of the best move count less the longer ago they happened
+		m_Instability *= 0.5f;
+
+		if (bestMove != m_LastBestMove)
+		{
+			m_Instability += 1.f;
+			m_BestMoveStableIterations = 0;
+		}
+		else
+		{
+			m_BestMoveStableIterations++;
+		}
+
+		const int scoreDrop = m_LastScore - score;
+		m_ScoreDropFactor = scoreDrop > c_ScoreDropMargin ? std::min(1.f + (float)scoreDrop / c_ScoreDropScale, 2.f) : 1.f;
+	}
+
+	m_LastBestMove = bestMove;
+	m_LastScore = score;
+	m_Iterations++;
+}
+
+bool TimeManager::ShouldStop() const
+{
+	float scale = (1.f + m_Instability) * m_ScoreDropFactor;
+
+	// One move kept winning every iteration, no need to use the full budget
+	if (m_BestMoveStableIterations >= 6 && m_ScoreDropFactor == 1.f)
+		scale *= 0.5f;
+
+	const Duration softLimit = std::chrono::duration_cast<Duration>(m_SoftLimit * scale);
+
+	// The next iteration takes at least as long as everything so far, so past half the
+	// budget it would most likely be cut off by the hard limit and thrown away
+	return Elapsed() * 2 >= std::min(softLimit, m_HardLimit);
+}
+
+void TimeManager::ResetStability()
+{
+	m_LastBestMove = 0;
+	m_LastScore = 0;
+	m_Iterations = 0;
+	m_BestMoveStableIterations = 0;
+	m_Instability = 0.f;
+	m_ScoreDropFactor = 1.f;
+}
+
+TimeManager::Duration TimeManager::Elapsed() const
+{
+	return std::chrono::duration_cast<Duration>(std::chrono::steady_clock::now() - m_StartTime);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "Clock.h"
+#include "Move.h"
+
+// Splits the remaining clock time into a soft limit, checked between iterations and
+// scaled by how settled the search is, and a hard limit the search never runs past
+class TimeManager
+{
+public:
+	using Duration = std::chrono::milliseconds;
+
+	void StartSearch(const ChessCore::Clock& clock, bool whiteToMove, uint16_t fullMoves);
+	void StartSearch(Duration fixedTime);
+
+	// Called after every completed iteration with its result
+	void OnIterationComplete(ChessCore::Move bestMove, int score);
+
+	// Between iterations: is it worth starting another one
+	bool ShouldStop() const;
+
+	// Inside the search
+	bool HardLimitReached() const { return Elapsed() >= m_HardLimit; }
+
+	Duration Elapsed() const;
+	Duration GetSoftLimit() const { return m_SoftLimit; }
+	Duration GetHardLimit() const { return m_HardLimit; }
+
+private:
+	void ResetStability();
+
+private:
+	// Kept back for move transmission and the game thread
+	static constexpr Duration c_MoveOverhead{ 50 };
+	static constexpr uint16_t c_MinMovesToGo = 20;
+	static constexpr uint16_t c_MaxMovesToGo = 40;
+
+	// Score drop (centipawns) from one iteration to the next that starts to buy extra time,
+	// a drop of c_ScoreDropMargin + c_ScoreDropScale doubles the time
+	static constexpr int c_ScoreDropMargin = 15;
+	static constexpr int c_ScoreDropScale = 50;
+
+	std::chrono::steady_clock::time_point m_StartTime{};
+
+	Duration m_SoftLimit{ 0 };
+	Duration m_HardLimit{ 0 };
+
+	// Search stability
+	ChessCore::Move m_LastBestMove = 0;
+	int m_LastScore = 0;
+	uint8_t m_Iterations = 0;
+	uint8_t m_BestMoveStableIterations = 0;
+	float m_Instability = 0.f;
+	float m_ScoreDropFactor = 1.f;
+};
@@ -28,8 +28,9 @@ TTEntry* TranspositionTable::Probe(uint64_t zobristKey)
 {
 	size_t idx = GetClusterIndex(zobristKey);
 	TTEntry* cluster = &m_Table[idx * m_ClusterSize];
+	const uint32_t key = GetEntryKey(zobristKey);
 	for (int i = 0; i < m_ClusterSize; i++) {
-		if (cluster[i].zobristKey == zobristKey)
+		if (cluster[i].key == key && cluster[i].depth >= 0)
 			return &cluster[i];
 	}
 	return nullptr;
@@ -37,7 +38,7 @@ TTEntry* TranspositionTable::Probe(uint64_t zobristKey)
 
 void TranspositionTable::Store(
 	uint64_t zobristKey,
-	float value, 
+	int16_t value, 
 	int8_t depth, 
 	EntryFlag flag, 
 	uint32_t bestMove,
@@ -47,8 +48,9 @@ void TranspositionTable::Store(
 	TTEntry* cluster = &m_Table[idx * m_ClusterSize];
 
 	// Step 1: try replacing an exact-key entry
+	const uint32_t key = GetEntryKey(zobristKey);
 	for (int i = 0; i < m_ClusterSize; ++i) {
-		if (cluster[i].zobristKey == zobristKey) {
+		if (cluster[i].key == key && cluster[i].depth >= 0) {
 			Write(cluster[i], zobristKey, value, depth, flag, bestMove, age);
 			return;
 		}
@@ -74,9 +76,9 @@ inline size_t TranspositionTable::GetClusterIndex(uint64_t zobristKey) const
 	return zobristKey % m_NumClusters;
 }
 
-void TranspositionTable::Write(TTEntry& e, uint64_t key, float value, int8_t depth, EntryFlag flag, uint32_t bestMove, int32_t age)
+void TranspositionTable::Write(TTEntry& e, uint64_t zobristKey, int16_t value, int8_t depth, EntryFlag flag, uint32_t bestMove, int32_t age)
 {
-	e.zobristKey = key;
+	e.key = GetEntryKey(zobristKey);
 	e.value = value;
 	e.depth = depth;
 	e.flag = flag;
@@ -86,7 +88,7 @@ void TranspositionTable::Write(TTEntry& e, uint64_t key, float value, int8_t dep
 
 int TranspositionTable::ReplacementScore(const TTEntry& e, int newDepth, int newAge) const
 {
-	if (e.zobristKey == 0) return 1'000'000'000;
+	if (e.depth < 0) return 1'000'000'000;
 
 	int agePenalty = (newAge - e.age);
 	int depthPenalty = (e.depth - newDepth);
@@ -10,14 +10,16 @@ enum class EntryFlag : uint8_t
 
 struct TTEntry
 {
-	uint64_t zobristKey = 0;        // zobrist hash
-	float value = 0;       // eval from search
-	int8_t depth = -1;        // search depth
-	EntryFlag flag = EntryFlag::EXACT;       // exact/lower/upper
+	uint32_t key = 0;        // upper half of the zobrist hash, the cluster index covers the rest
 	ChessCore::Move bestMove = 0;  // packed move
+	int16_t value = 0;       // centipawns from search, mates relative to this node
 	int16_t age = 0;         // ply or generation
+	int8_t depth = -1;        // search depth, -1 while empty
+	EntryFlag flag = EntryFlag::EXACT;       // exact/lower/upper
 };
 
+static_assert(sizeof(TTEntry) == 16, "four entries per 64 byte cluster");
+
 class TranspositionTable
 {
 public:
@@ -34,7 +36,7 @@ public:
 	// Store entry
 	void Store(
 		uint64_t zobristKey,
-		float value,
+		int16_t value,
 		int8_t depth,
 		EntryFlag flag,
 		uint32_t bestMove,
@@ -45,10 +47,11 @@ private:
 	
 
 	size_t GetClusterIndex(uint64_t zobristKey) const;
+	static uint32_t GetEntryKey(uint64_t zobristKey) { return (uint32_t)(zobristKey >> 32); }
 
 	void Write(TTEntry& e,
 		uint64_t zobristKey,
-		float value,
+		int16_t value,
 		int8_t depth,
 		EntryFlag flag,
 		uint32_t bestMove,
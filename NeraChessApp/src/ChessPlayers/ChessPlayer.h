@@ -1,8 +1,12 @@
 #pragma once
 
+#include <optional>
+
 #include "ChessBoard.h"
 #include "Clock.h"
 
+#include "Bots/SearchStats.h"
+
 class ChessPlayer
 {
 public:
@@ -12,4 +16,10 @@ public:
 	virtual ChessCore::Move GetNextMove(const ChessCore::ChessBoard& board, const ChessCore::Clock& timer) = 0;
 	virtual void ResetGame() = 0;
 	virtual void StopSearching() = 0;
+
+	// Score of the last search in centipawns from the mover's point of view, players without a score return nullopt
+	virtual std::optional<int> GetLastScore() const { return std::nullopt; }
+
+	// Statistics of the current or last search, for players that search
+	virtual std::optional<SearchStats> GetSearchStats() const { return std::nullopt; }
 };
\ No newline at end of file
@@ -6,6 +6,9 @@
 
 #include <thread>
 #include <print>
+#include <chrono>
+#include <format>
+#include <string>
 
 template<typename TPlayer1, typename TPlayer2>
 void GameManagerLayer::SetPlayerTypes()
@@ -75,9 +78,22 @@ void GameManagerLayer::StopGame()
 
 void GameManagerLayer::RunGame(ChessCore::ChessBoard board)
 {
-	m_Clock.Start();
+	m_Clock.Start(board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove));
 	m_GameStarted = true;
 
+	const bool whiteStarts = board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove);
+	const bool player1IsWhite = m_Player1IsWhite;
+
+	ChessCore::PGNWriter pgn(board);
+	pgn.SetTag("Event", "NeraChess Game");
+	pgn.SetTag("Site", "NeraChess");
+	pgn.SetTag("Date", std::format("{:%Y.%m.%d}", std::chrono::floor<std::chrono::days>(std::chrono::system_clock::now())));
+	pgn.SetTag("White", player1IsWhite ? "Player 1" : "Player 2");
+	pgn.SetTag("Black", player1IsWhite ? "Player 2" : "Player 1");
+	pgn.SetTag("TimeControl", std::format("{}+{}",
+		std::chrono::duration_cast<std::chrono::seconds>(m_Clock.GetBaseTime(whiteStarts)).count(),
+		std::chrono::duration_cast<std::chrono::seconds>(m_Clock.GetIncrement(whiteStarts)).count()));
+
 	while (m_GameStarted)
 	{
 
@@ -93,6 +109,14 @@ void GameManagerLayer::RunGame(ChessCore::ChessBoard board)
 			break;
 		}
 
+		if (m_Clock.IsFlagged(m_Clock.IsWhiteToMove()))
+		{
+			std::print("Game over, {} ran out of time \n\n", (m_Player1Turn ? "Player 1" : "Player 2"));
+			pgn.SetResult(m_Clock.IsWhiteToMove() ? "0-1" : "1-0");
+			pgn.SetTag("Termination", "time forfeit");
+			break;
+		}
+
 		ChessCore::MoveList<218> legalMoves = board.GetLegalMoves();
 		if (std::find(legalMoves.begin(), legalMoves.end(), move) == legalMoves.end())
 		{
@@ -100,6 +124,10 @@ void GameManagerLayer::RunGame(ChessCore::ChessBoard board)
 			break;
 		}
 
+		const bool whiteToMove = board.GetBoardState().HasFlag(ChessCore::BoardStateFlags::WhiteToMove);
+		// The clock as it stands after the move, with the increment Press() adds below
+		pgn.AddMove(move, m_Clock.GetRemainingTime(whiteToMove) + m_Clock.GetIncrement(whiteToMove));
+
 		board.MakeMove(move, true);
 
 		m_MoveQueue.Push(move);
@@ -132,7 +160,12 @@ void GameManagerLayer::RunGame(ChessCore::ChessBoard board)
 
 			std::print("Game over, {} ends the game by {} \n\n", (m_Player1Turn ? "Player 1" : "Player 2"), gameOverReason);
 
-			//std::cout << m_ChessBoard.GetSANMoveList() << "\n\n"; TODO: enable san move list printing
+			if (gameOverFlags & (uint16_t)ChessCore::GameOverFlags::IS_CHECKMATE)
+				pgn.SetResult(whiteToMove ? "1-0" : "0-1");
+			else
+				pgn.SetResult("1/2-1/2");
+
+			std::print("{}", pgn.ToString());
 			break;
 		}
 
@@ -142,6 +175,11 @@ void GameManagerLayer::RunGame(ChessCore::ChessBoard board)
 		m_Player1Turn = !m_Player1Turn;
 	}
 
+	m_Clock.Stop();
+
+	if (!pgn.AppendToFile(c_GameRecordPath))
+		std::println("Could not save the game to {}", c_GameRecordPath);
+
 	Reset();
 }
 
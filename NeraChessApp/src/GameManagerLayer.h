@@ -5,11 +5,14 @@
 #include "ChessBoard.h"
 #include "Clock.h"
 #include "MoveQueue.h"
+#include "PGN.h"
 
 #include "ChessPlayers/AllPlayer.h"
 
 #include <memory>
 #include <atomic>
+#include <optional>
+#include <string>
 
 class GameManagerLayer : public NeraCore::Layer
 {
@@ -27,12 +30,18 @@ public:
 	void StartGame();
 	void StopGame();
 
+	// Live statistics of a player's search, safe to call from the render thread
+	std::optional<SearchStats> GetSearchStats(bool player1) const { return (player1 ? m_Player1 : m_Player2)->GetSearchStats(); }
+
 private:
 	void RunGame(ChessCore::ChessBoard board);
 	void Reset();
 
 private:
 
+	// Every finished or aborted game is appended here
+	static inline const std::string c_GameRecordPath = "Ressources/Games/NeraChessGames.pgn";
+
 	ChessCore::Clock m_Clock{};
 	ChessCore::ChessBoard m_ChessBoard{};
 
@@ -6,6 +6,48 @@
 
 #include "imgui.h"
 
+// Live view of one player's search, players that don't search have nothing to show
+static void DrawSearchStats(const char* label, const std::optional<SearchStats>& stats)
+{
+	if (!stats || !ImGui::CollapsingHeader(label))
+		return;
+
+	ImGui::PushID(label);
+
+	ImGui::Text("Depth %d, %llu nodes, %llu nps, %lld ms",
+		stats->iterations.empty() ? 0 : (int)stats->iterations.back().depth,
+		(unsigned long long)stats->nodes, (unsigned long long)stats->GetNodesPerSecond(), (long long)stats->milliseconds);
+	ImGui::Text("Branching factor: %.2f", stats->GetBranchingFactor());
+	ImGui::Text("Quiescence nodes: %.1f%%", 100.0 * stats->GetQuiescenceFraction());
+	ImGui::Text("TT hits: %.1f%%, cutoffs: %llu", 100.0 * stats->GetTTHitRate(), (unsigned long long)stats->ttCutoffs);
+	ImGui::Text("Cutoffs on the first move: %.1f%%", 100.0 * stats->GetFirstMoveCutoffRate());
+	ImGui::Text("Network: %llu calls, %.1f%% cached, %llu skipped", (unsigned long long)stats->networkEvaluations,
+		100.0 * stats->GetNetworkCacheHitRate(), (unsigned long long)stats->networkEvaluationsSkipped);
+	ImGui::Text("LMR: %llu reduced, %.1f%% re-searched", (unsigned long long)stats->reducedSearches, 100.0 * stats->GetReSearchRate());
+
+	if (ImGui::BeginTable("Iterations", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+	{
+		ImGui::TableSetupColumn("Depth");
+		ImGui::TableSetupColumn("Score");
+		ImGui::TableSetupColumn("Nodes");
+		ImGui::TableSetupColumn("ms");
+		ImGui::TableHeadersRow();
+
+		for (const IterationStats& iteration : stats->iterations)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn(); ImGui::Text("%d", (int)iteration.depth);
+			ImGui::TableNextColumn(); ImGui::Text("%d", iteration.score);
+			ImGui::TableNextColumn(); ImGui::Text("%llu", (unsigned long long)iteration.nodes);
+			ImGui::TableNextColumn(); ImGui::Text("%lld", (long long)iteration.milliseconds);
+		}
+
+		ImGui::EndTable();
+	}
+
+	ImGui::PopID();
+}
+
 void UILayer::OnRender()
 {
 	GameManagerLayer* gameManager = NeraCore::Application::Get().GetLayer<GameManagerLayer>();
@@ -22,5 +64,8 @@ void UILayer::OnRender()
 		gameManager->StopGame();
 	}
 
+	DrawSearchStats("Player 1 Search", gameManager->GetSearchStats(true));
+	DrawSearchStats("Player 2 Search", gameManager->GetSearchStats(false));
+
 	ImGui::End();
 }
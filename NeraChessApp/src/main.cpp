@@ -5,6 +5,10 @@
 #include "GameManagerLayer.h"
 #include "UILayer.h"
 
+#include "ChessPlayers/Bots/NeuralNetwork.h"
+
+#include <cassert>
+
 int main()
 {
 	NeraCore::ApplicationSpecification appSpecs;
@@ -12,6 +16,12 @@ int main()
 	appSpecs.WindowSpec.Width = 1280;
 	appSpecs.WindowSpec.Height = 720;
 
+#ifdef DEBUG
+	// The tensor encoder keeps state per batch slot, stale planes would silently feed the network wrong inputs
+	const bool encoderMatches = NeuralNetwork::RunEncoderCheck();
+	assert(encoderMatches);
+#endif
+
 	NeraCore::Application app(appSpecs);
 
 	app.PushLayer<BackgroundLayer>();
@@ -0,0 +1,56 @@
+project "TrainingData"
+  kind "SharedLib"
+  language "C++"
+  cppdialect "C++23"
+  targetdir ("../bin/%{cfg.buildcfg}/%{prj.name}")
+  objdir ("../bin/Intermediates/%{cfg.buildcfg}/%{prj.name}")
+  staticruntime "off"
+
+  -- Loaded by TrainAI.py through ctypes, see TrainingData.h for the exported functions
+  files
+  {
+    "src/**.cpp",
+    "src/**.h",
+  }
+
+  includedirs
+  {
+    "src",
+
+    "../ChessCore/src",
+  }
+
+  links
+  {
+    "ChessCore",
+  }
+
+  defines { "TRAINING_DATA_EXPORTS" }
+
+  -- Platform
+
+  filter "system:windows"
+    systemversion "latest"
+    defines { "WINDOWS" }
+  filter {}
+
+  -- Configurations
+
+  filter "configurations:Debug"
+    defines { "DEBUG" }
+    runtime "Debug"
+    symbols "On"
+
+  filter "configurations:Release"
+    defines { "RELEASE" }
+    runtime "Release"
+    optimize "On"
+    symbols "On"
+
+  filter "configurations:Dist"
+    defines { "DIST" }
+    runtime "Release"
+    optimize "On"
+    symbols "Off"
+
+  filter {}
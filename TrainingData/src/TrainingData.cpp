@@ -0,0 +1,83 @@
+#include "TrainingData.h"
+
+#include <algorithm>
+#include <array>
+
+#include "PackedPosition.h"
+
+static constexpr int c_PlaneSize = 8 * 8;
+static constexpr int c_InputTensorSize = 19 * c_PlaneSize;
+static constexpr int c_EnPassantPlane = 17;
+static constexpr std::array<int, 6> c_BroadcastPlanes = { 12, 13, 14, 15, 16, 18 };
+
+static void FillPlane(float* plane, float value)
+{
+	std::fill(plane, plane + c_PlaneSize, value);
+}
+
+// Same layout as NeuralNetwork::BoardToTensor, [plane][file][rank] with rank 0 being white's first rank
+static void WriteTensor(const ChessCore::PackedPosition& record, float* out)
+{
+	std::fill(out, out + c_InputTensorSize, 0.0f);
+
+	record.ForEachPiece([&](uint8_t square, uint8_t piece)
+		{
+			if (piece <= ChessCore::PieceType::BLACK_KING)
+				out[piece * c_PlaneSize + (square & 7) * 8 + (square >> 3)] = 1.0f;
+		});
+
+	if ((record.flags & ChessCore::BoardStateFlags::CanEnPassent) && record.enPassantFile <= 7)
+	{
+		// only that file
+		float* file = &out[c_EnPassantPlane * c_PlaneSize + record.enPassantFile * 8];
+		std::fill(file, file + 8, 1.0f);
+	}
+
+	const std::array<float, 6> broadcastValues = {
+		(record.flags & ChessCore::BoardStateFlags::WhiteToMove) ? 1.0f : 0.0f,
+		(record.flags & ChessCore::BoardStateFlags::CanWhiteCastleKing) ? 1.0f : 0.0f,
+		(record.flags & ChessCore::BoardStateFlags::CanWhiteCastleQueen) ? 1.0f : 0.0f,
+		(record.flags & ChessCore::BoardStateFlags::CanBlackCastleKing) ? 1.0f : 0.0f,
+		(record.flags & ChessCore::BoardStateFlags::CanBlackCastleQueen) ? 1.0f : 0.0f,
+		static_cast<float>(record.halfMoveClock) / 50.0f,
+	};
+
+	for (size_t i = 0; i < c_BroadcastPlanes.size(); i++)
+	{
+		if (broadcastValues[i] != 0.0f)
+			FillPlane(&out[c_BroadcastPlanes[i] * c_PlaneSize], broadcastValues[i]);
+	}
+}
+
+uint32_t TrainingData_GetRecordSize()
+{
+	return sizeof(ChessCore::PackedPosition);
+}
+
+void TrainingData_DecodeBatch(const void* records, const uint64_t* indices, uint64_t count,
+	float* tensors, float* scores, float* results)
+{
+	const ChessCore::PackedPosition* positions = static_cast<const ChessCore::PackedPosition*>(records);
+
+	for (uint64_t i = 0; i < count; i++)
+	{
+		const ChessCore::PackedPosition& record = positions[indices ? indices[i] : i];
+
+		if (tensors)
+			WriteTensor(record, &tensors[i * c_InputTensorSize]);
+
+		if (scores)
+			scores[i] = static_cast<float>(record.score);
+
+		if (results)
+		{
+			switch (record.result)
+			{
+			case ChessCore::TrainingResult::WHITE_WIN: results[i] = 1.0f; break;
+			case ChessCore::TrainingResult::DRAW:      results[i] = 0.5f; break;
+			case ChessCore::TrainingResult::BLACK_WIN: results[i] = 0.0f; break;
+			default:                                   results[i] = -1.0f; break;
+			}
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// C interface to the packed training positions, loaded by TrainAI.py with ctypes.
+// Records are ChessCore::PackedPosition (32 bytes each), usually a memory mapped .bin from DataConverter
+
+#ifdef _WIN32
+	#ifdef TRAINING_DATA_EXPORTS
+		#define TRAINING_DATA_API __declspec(dllexport)
+	#else
+		#define TRAINING_DATA_API __declspec(dllimport)
+	#endif
+#else
+	#define TRAINING_DATA_API __attribute__((visibility("default")))
+#endif
+
+extern "C"
+{
+	// Size of one record in bytes, lets the trainer check it was built against the same format
+	TRAINING_DATA_API uint32_t TrainingData_GetRecordSize();
+
+	// Decodes count records into the network input, 19 * 8 * 8 floats per position laid out like
+	// NeuralNetwork::BoardToTensor. Record i is records[indices[i]], or records[i] when indices is null.
+	// scores gets the centipawn scores and results 1 / 0.5 / 0 (-1 when unknown), both from white's point of view,
+	// either may be null
+	TRAINING_DATA_API void TrainingData_DecodeBatch(const void* records, const uint64_t* indices, uint64_t count,
+		float* tensors, float* scores, float* results);
+}